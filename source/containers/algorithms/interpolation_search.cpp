@@ -0,0 +1,138 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <operators/forward.hpp>
+
+export module containers.algorithms.interpolation_search;
+
+import containers.algorithms.advance;
+import containers.algorithms.binary_search;
+import containers.array;
+import containers.begin_end;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.range_view;
+
+import bounded;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+constexpr auto to_interpolation_value(auto const & value) -> double {
+	if constexpr (bounded::bounded_integer<decltype(value)>) {
+		return static_cast<double>(value.value());
+	} else {
+		static_assert(std::is_arithmetic_v<std::remove_cvref_t<decltype(value)>>);
+		return static_cast<double>(value);
+	}
+}
+
+// After this many guesses, the rest of the search is a binary search. This
+// bounds the cost when the keys are not evenly spread.
+constexpr auto maximum_interpolation_probes = 4;
+
+// For fewer elements than this, a binary search is about as fast
+constexpr auto minimum_interpolation_size = std::ptrdiff_t(16);
+
+// Returns the same as `lower_bound`, but for a sorted range of numbers. Each
+// step guesses where `value` is from the values at the ends of the part of
+// the range that is left. When the values are spread about evenly, this takes
+// a few reads instead of log2(n).
+//
+// `to_key` turns an element into a number that is in the same order as `cmp`.
+// Only `cmp` decides the result, so a bad guess costs time but not
+// correctness.
+struct interpolation_lower_bound_t {
+	static constexpr auto operator()(range auto && sorted, auto const & value, auto cmp, auto to_key) {
+		auto first = containers::begin(sorted);
+		auto last = containers::end(sorted);
+		using difference_type = iter_difference_t<decltype(first)>;
+		auto const target = ::containers::to_interpolation_value(value);
+		for (auto probes = 0; probes != maximum_interpolation_probes; ++probes) {
+			auto const size = static_cast<std::ptrdiff_t>(last - first);
+			if (size < minimum_interpolation_size) {
+				break;
+			}
+			if (!cmp(*first, value)) {
+				return first;
+			}
+			auto const back = containers::prev(last);
+			if (cmp(*back, value)) {
+				return last;
+			}
+			auto const low = ::containers::to_interpolation_value(to_key(*first));
+			auto const high = ::containers::to_interpolation_value(to_key(*back));
+			auto const fraction = (target - low) / (high - low);
+			// Also false for NaN, if `high == low` after rounding
+			if (!(fraction >= 0.0 and fraction <= 1.0)) {
+				break;
+			}
+			auto const offset = static_cast<std::ptrdiff_t>(fraction * static_cast<double>(size - 1));
+			auto const probe = first + ::bounded::assume_in_range<difference_type>(offset);
+			if (cmp(*probe, value)) {
+				first = containers::next(probe);
+			} else {
+				last = probe;
+			}
+		}
+		return containers::lower_bound(range_view(first, last), value, cmp);
+	}
+	static constexpr auto operator()(range auto && sorted, auto const & value) {
+		return operator()(OPERATORS_FORWARD(sorted), value, std::less(), std::identity());
+	}
+};
+export constexpr auto interpolation_lower_bound = interpolation_lower_bound_t();
+
+} // namespace containers
+
+constexpr auto matches_lower_bound(auto const & sorted, auto const first_value, auto const last_value) -> bool {
+	for (auto value = first_value; value != last_value; ++value) {
+		if (containers::interpolation_lower_bound(sorted, value) != containers::lower_bound(sorted, value)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+constexpr auto zero = containers::array<int, 0_bi>{};
+constexpr auto three = containers::array{1, 2, 3};
+
+static_assert(containers::interpolation_lower_bound(zero, 0) == containers::end(zero));
+static_assert(matches_lower_bound(three, 0, 5));
+
+template<typename T, auto size>
+constexpr auto make_sorted(auto const function) {
+	auto result = containers::array<T, size>();
+	auto n = 0;
+	for (auto & value : result) {
+		value = function(n);
+		++n;
+	}
+	return result;
+}
+
+constexpr auto evenly_spread = make_sorted<int, 100_bi>([](int const n) { return n * 10; });
+static_assert(matches_lower_bound(evenly_spread, -5, 1005));
+
+constexpr auto skewed = make_sorted<std::int64_t, 60_bi>([](int const n) { return std::int64_t(1) << n; });
+static_assert(matches_lower_bound(skewed, std::int64_t(-3), std::int64_t(1000)));
+static_assert(containers::interpolation_lower_bound(skewed, std::int64_t(1) << 50) == containers::begin(skewed) + 50_bi);
+static_assert(containers::interpolation_lower_bound(skewed, (std::int64_t(1) << 59) + 1) == containers::end(skewed));
+
+constexpr auto duplicates = make_sorted<int, 40_bi>([](int const n) { return n / 8; });
+static_assert(matches_lower_bound(duplicates, -1, 7));
+
+using bounded_key = bounded::integer<0, 1000>;
+constexpr auto bounded_keys = make_sorted<bounded_key, 30_bi>([](int const n) {
+	return bounded::assume_in_range<bounded_key>(n * 7);
+});
+static_assert(containers::interpolation_lower_bound(bounded_keys, 0_bi) == containers::begin(bounded_keys));
+static_assert(containers::interpolation_lower_bound(bounded_keys, 21_bi) == containers::begin(bounded_keys) + 3_bi);
+static_assert(containers::interpolation_lower_bound(bounded_keys, 22_bi) == containers::begin(bounded_keys) + 4_bi);
+static_assert(containers::interpolation_lower_bound(bounded_keys, 1000_bi) == containers::end(bounded_keys));
@@ -0,0 +1,70 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+export module containers.algorithms.parallel_for_each_index;
+
+import containers.emplace_back;
+import containers.vector;
+
+import bounded;
+import numeric_traits;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+export using thread_count_t = bounded::integer<1, 1024>;
+
+export auto default_thread_count() -> thread_count_t {
+	// hardware_concurrency is allowed to return 0 if it cannot tell
+	return bounded::clamp(
+		bounded::integer(std::thread::hardware_concurrency()),
+		numeric_traits::min_value<thread_count_t>,
+		numeric_traits::max_value<thread_count_t>
+	);
+}
+
+// Calls `function(index)` once for every index in [0, count), using up to
+// `threads` threads (including the calling thread). Indexes are handed out one
+// at a time, so a thread that finishes a cheap index picks up the next one
+// rather than waiting on a thread that got an expensive one. If `function`
+// throws, no more indexes are handed out, and the first exception is rethrown
+// once every thread has finished.
+export auto parallel_for_each_index(thread_count_t const threads, std::size_t const count, auto const & function) -> void {
+	auto next = std::atomic<std::size_t>(0);
+	auto exception = std::exception_ptr();
+	auto exception_mutex = std::mutex();
+	auto worker = [&] {
+		try {
+			while (true) {
+				auto const index = next.fetch_add(1, std::memory_order_relaxed);
+				if (index >= count) {
+					return;
+				}
+				function(index);
+			}
+		} catch (...) {
+			next.store(count, std::memory_order_relaxed);
+			auto const lock = std::scoped_lock(exception_mutex);
+			if (!exception) {
+				exception = std::current_exception();
+			}
+		}
+	};
+	{
+		auto const additional_threads = std::min(static_cast<std::size_t>(threads), count);
+		auto workers = containers::vector<std::jthread>();
+		for (std::size_t n = 1; n < additional_threads; ++n) {
+			::containers::emplace_back(workers, worker);
+		}
+		worker();
+	}
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
+} // namespace containers
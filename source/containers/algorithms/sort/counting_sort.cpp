@@ -0,0 +1,187 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.algorithms.sort.counting_sort;
+
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.test_sort_inplace_and_relocate;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.array;
+import containers.begin_end;
+import containers.integer_range;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.range_value_t;
+import containers.size;
+import containers.vector;
+
+import bounded;
+import numeric_traits;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+// When a key has only a few possible values, one pass to count each key and one
+// pass to put every element in place beats any comparison or multi-byte radix
+// sort.
+export constexpr auto counting_sort_maximum_key_count = bounded::constant<4096>;
+
+// to_radix_sort_key does not change the order of integers, so integers are
+// counted by their own value. This keeps the original range, which may be much
+// narrower than the radix key.
+template<typename Value, typename ExtractKey>
+struct counting_sort_key_impl {
+	using type = std::decay_t<std::invoke_result_t<ExtractKey const &, Value const &>>;
+};
+
+template<bounded::integral Value>
+struct counting_sort_key_impl<Value, to_radix_sort_key_t> {
+	using type = Value;
+};
+
+template<typename Value, typename ExtractKey>
+using counting_sort_key = typename counting_sort_key_impl<Value, ExtractKey>::type;
+
+template<typename Value, typename ExtractKey>
+constexpr auto key_only =
+	(std::same_as<ExtractKey, to_radix_sort_key_t> or std::same_as<ExtractKey, std::identity>) and
+	bounded::integral<Value>;
+
+template<typename Key>
+constexpr auto key_count =
+	numeric_traits::max_value<decltype(bounded::integer(bounded::declval<Key>()))> -
+	numeric_traits::min_value<decltype(bounded::integer(bounded::declval<Key>()))> +
+	1_bi;
+
+// Key-only ranges are rebuilt from the counts. Anything else is copied to a
+// buffer and copied back, so it must be cheap to copy.
+export template<typename Range, typename ExtractKey>
+concept counting_sortable =
+	range<Range> and
+	bounded::integral<counting_sort_key<range_value_t<Range>, ExtractKey>> and
+	key_count<counting_sort_key<range_value_t<Range>, ExtractKey>> <= counting_sort_maximum_key_count and
+	(
+		key_only<range_value_t<Range>, ExtractKey> or
+		(random_access_range<Range> and std::is_trivially_copyable_v<range_value_t<Range>>)
+	);
+
+template<typename ExtractKey>
+constexpr auto counting_sort_index(ExtractKey const & extract_key, auto const & value) {
+	auto const key = [&] {
+		if constexpr (std::same_as<ExtractKey, to_radix_sort_key_t> and bounded::integral<std::decay_t<decltype(value)>>) {
+			return bounded::integer(value);
+		} else {
+			return bounded::integer(extract_key(value));
+		}
+	}();
+	return key - numeric_traits::min_value<decltype(key)>;
+}
+
+// Clearing and scanning the counts costs about as much as sorting a few
+// elements per key, so small inputs are better off with a radix sort.
+export template<typename ExtractKey>
+constexpr auto prefer_counting_sort(range auto const & to_sort, ExtractKey const &) -> bool {
+	using key_t = counting_sort_key<range_value_t<decltype(to_sort)>, ExtractKey>;
+	return containers::size(to_sort) * 8_bi >= key_count<key_t>;
+}
+
+struct counting_sort_t {
+	template<typename Range, typename ExtractKey> requires counting_sortable<Range, ExtractKey>
+	static constexpr auto operator()(Range && to_sort, ExtractKey const & extract_key) -> void {
+		using value_type = range_value_t<Range>;
+		using key_t = counting_sort_key<value_type, ExtractKey>;
+		auto counts = containers::array<std::size_t, key_count<key_t>>();
+		for (auto const & value : to_sort) {
+			++counts[::containers::counting_sort_index(extract_key, value)];
+		}
+		if constexpr (key_only<value_type, ExtractKey>) {
+			constexpr auto min = numeric_traits::min_value<decltype(bounded::integer(bounded::declval<key_t>()))>;
+			auto it = containers::begin(to_sort);
+			for (auto const index : containers::integer_range(key_count<key_t>)) {
+				auto const value = ::bounded::assume_in_range<value_type>(index + min);
+				for (auto count = counts[index]; count != 0; --count) {
+					*it = value;
+					++it;
+				}
+			}
+		} else {
+			auto offset = std::size_t(0);
+			for (auto & count : counts) {
+				offset += std::exchange(count, offset);
+			}
+			auto const buffer = containers::vector<value_type>(to_sort);
+			auto const first = containers::begin(to_sort);
+			using difference_type = iter_difference_t<decltype(first)>;
+			for (auto const & value : buffer) {
+				auto & position = counts[::containers::counting_sort_index(extract_key, value)];
+				*(first + ::bounded::assume_in_range<difference_type>(position)) = value;
+				++position;
+			}
+		}
+	}
+	template<typename Range> requires counting_sortable<Range, to_radix_sort_key_t>
+	static constexpr auto operator()(Range && to_sort) -> void {
+		operator()(to_sort, to_radix_sort_key);
+	}
+};
+export constexpr auto counting_sort = counting_sort_t();
+
+} // namespace containers
+
+using namespace containers_test;
+
+static_assert(test_sort(uint8_0, containers::counting_sort));
+static_assert(test_sort(uint8_1, containers::counting_sort));
+static_assert(test_sort(uint8_2, containers::counting_sort));
+static_assert(test_sort(uint8_3, containers::counting_sort));
+static_assert(test_sort(containers::array{uint8_many}, containers::counting_sort));
+static_assert(test_sort(containers::array{uint8_256}, containers::counting_sort));
+
+static_assert(containers::counting_sortable<containers::array<std::int8_t, 2_bi>, containers::to_radix_sort_key_t>);
+static_assert(containers::counting_sortable<containers::array<bounded::integer<1000, 1255>, 2_bi>, containers::to_radix_sort_key_t>);
+static_assert(containers::counting_sortable<containers::array<bounded::integer<-2000, 2000>, 2_bi>, std::identity>);
+static_assert(!containers::counting_sortable<containers::array<bounded::integer<0, 4096>, 2_bi>, std::identity>);
+static_assert(!containers::counting_sortable<containers::array<std::uint16_t, 2_bi>, containers::to_radix_sort_key_t>);
+static_assert(!containers::counting_sortable<containers::array<bool, 2_bi>, containers::to_radix_sort_key_t>);
+
+static_assert([] {
+	using value_type = bounded::integer<-2000, 2000>;
+	auto to_sort = containers::array<value_type, 5_bi>{15_bi, -2000_bi, 2000_bi, 15_bi, -1_bi};
+	containers::counting_sort(to_sort);
+	BOUNDED_ASSERT(to_sort == containers::array<value_type, 5_bi>{-2000_bi, -1_bi, 15_bi, 15_bi, 2000_bi});
+	return true;
+}());
+
+struct record {
+	bounded::integer<1000, 1255> id;
+	int payload;
+	friend auto operator==(record, record) -> bool = default;
+};
+
+static_assert([] {
+	auto to_sort = containers::array{
+		record(1002_bi, 0),
+		record(1000_bi, 1),
+		record(1255_bi, 2),
+		record(1002_bi, 3),
+		record(1000_bi, 4),
+	};
+	containers::counting_sort(to_sort, [](record const & value) { return value.id; });
+	BOUNDED_ASSERT(to_sort == containers::array{
+		record(1000_bi, 1),
+		record(1000_bi, 4),
+		record(1002_bi, 0),
+		record(1002_bi, 3),
+		record(1255_bi, 2),
+	});
+	return true;
+}());
@@ -11,17 +11,16 @@ module;
 
 export module containers.algorithms.sort.double_buffered_ska_sort;
 
+import containers.algorithms.sort.lsd_radix_sort;
 import containers.algorithms.sort.to_radix_sort_key;
 
 import containers.algorithms.advance;
 import containers.algorithms.count;
 import containers.algorithms.minmax_element;
 import containers.algorithms.reverse_iterator;
-import containers.array;
 import containers.begin_end;
 import containers.c_array;
 import containers.front_back;
-import containers.index_type;
 import containers.integer_range;
 import containers.is_range;
 import containers.range_value_t;
@@ -96,43 +95,6 @@ constexpr auto bool_sort_copy(auto & source, auto & output, auto const & extract
 }
 
 
-template<range Source, range Buffer, typename ExtractKey>
-constexpr auto double_buffered_numeric_sort(Source & source, Buffer & buffer, ExtractKey const & extract_key) -> bool {
-	constexpr auto size = bounded::size_of<std::decay_t<decltype(extract_key(containers::front(source)))>>;
-	auto counts = containers::array<std::size_t, size, 256_bi>();
-	auto const index_range = integer_range(size);
-
-	for (auto const & value : source) {
-		auto key = bounded::integer(extract_key(value));
-		for (auto const index : index_range) {
-			auto const inner_index = (key >> (index * 8_bi)) % 256_bi;
-			++counts[index][inner_index];
-		}
-	}
-	auto total = containers::array<std::size_t, size>();
-	for (auto const index : index_range) {
-		auto & indexed_total = total[index];
-		auto & count = counts[index];
-		for (auto const i : containers::integer_range(256_bi)) {
-			indexed_total += std::exchange(count[i], indexed_total);
-		}
-	}
-	for (auto index_it = containers::begin(index_range); index_it != containers::end(index_range); ) {
-		auto sort_segment_copy = [&](auto & current, auto & next) {
-			for (auto && value : current) {
-				auto const key = (bounded::integer(extract_key(value)) >> (*index_it * 8_bi)) % 256_bi;
-				next[::bounded::assume_in_range<containers::index_type<Buffer>>(counts[*index_it][key]++)] = std::move(value);
-			}
-			++index_it;
-		};
-		sort_segment_copy(source, buffer);
-		if constexpr (size % 2_bi == 0_bi) {
-			sort_segment_copy(buffer, source);
-		}
-	}
-	return size % 2_bi == 1_bi;
-}
-
 constexpr auto double_buffered_sort_impl(range auto & source, range auto & buffer, auto const & original_extractor, auto const & current_extractor) -> bool;
 
 template<typename OriginalExtractor, typename CurrentExtractor, std::size_t... indexes>
@@ -195,7 +157,7 @@ constexpr auto double_buffered_sort_impl(range auto & source, range auto & buffe
 		::containers::bool_sort_copy(source, buffer, current_extractor);
 		return true;
 	} else if constexpr (bounded::unsigned_builtin<key_t>) {
-		return ::containers::double_buffered_numeric_sort(source, buffer, current_extractor);
+		return ::containers::lsd_radix_sort(source, buffer, current_extractor);
 	} else if constexpr (containers::range<key_t>) {
 		return ::containers::double_buffered_range_sort(source, buffer, original_extractor, current_extractor);
 	} else {
@@ -0,0 +1,332 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Sorts files of fixed-size records that are larger than the memory that can
+// be used to sort them. The input is read in pieces that fit within the memory
+// limit, each piece is sorted with ska_sort and written to a temporary file,
+// and then the sorted runs are merged. If there are too many runs to merge at
+// once with a reasonably sized buffer for each of them, groups of runs are
+// merged into longer runs first.
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.algorithms.sort.external_sort;
+
+import containers.algorithms.sort.ska_sort;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.data;
+import containers.front_back;
+import containers.push_back;
+import containers.range_view;
+import containers.size;
+import containers.uninitialized_dynamic_array;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace containers {
+
+export template<typename T>
+concept external_sortable = std::is_trivially_copyable_v<T> and !std::is_const_v<T>;
+
+export struct external_sort_options {
+	// The number of bytes of records held in memory at once, both while
+	// forming runs and while merging them
+	std::size_t memory_limit = 256U * 1024U * 1024U;
+	std::filesystem::path temporary_directory = std::filesystem::temp_directory_path();
+};
+
+// Each run being merged gets at least this much of the memory limit. Smaller
+// reads spend more time seeking between files than reading them.
+constexpr auto minimum_merge_buffer_bytes = std::size_t(64U * 1024U);
+
+template<typename T>
+using record_buffer = uninitialized_dynamic_array<T, std::size_t>;
+
+struct temporary_file {
+	explicit temporary_file(std::filesystem::path path_):
+		path(std::move(path_))
+	{
+	}
+	temporary_file(temporary_file && other) noexcept:
+		path(std::exchange(other.path, std::filesystem::path()))
+	{
+	}
+	auto operator=(temporary_file && other) & noexcept -> temporary_file & {
+		remove();
+		path = std::exchange(other.path, std::filesystem::path());
+		return *this;
+	}
+	~temporary_file() {
+		remove();
+	}
+
+	std::filesystem::path path;
+
+private:
+	auto remove() noexcept -> void {
+		if (!path.empty()) {
+			auto ignored = std::error_code();
+			std::filesystem::remove(path, ignored);
+		}
+	}
+};
+
+// Names do not collide with other sorts running at the same time in the same
+// directory
+struct temporary_file_names {
+	explicit temporary_file_names(std::filesystem::path directory):
+		m_directory(std::move(directory)),
+		m_prefix("containers_external_sort_" + std::to_string(std::random_device()()) + "_" + std::to_string(std::random_device()()) + "_")
+	{
+	}
+	auto next() -> temporary_file {
+		auto result = temporary_file(m_directory / (m_prefix + std::to_string(m_count) + ".tmp"));
+		++m_count;
+		return result;
+	}
+
+private:
+	std::filesystem::path m_directory;
+	std::string m_prefix;
+	std::size_t m_count = 0;
+};
+
+auto open_file(std::filesystem::path const & path, std::ios::openmode const mode) {
+	auto file = std::fstream(path, mode | std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Unable to open " + path.string());
+	}
+	return file;
+}
+
+template<typename T>
+auto read_records(std::fstream & file, T * const buffer, std::size_t const max_count) -> std::size_t {
+	file.read(reinterpret_cast<char *>(buffer), static_cast<std::streamsize>(max_count * sizeof(T)));
+	if (file.bad()) {
+		throw std::runtime_error("Unable to read records");
+	}
+	auto const bytes = static_cast<std::size_t>(file.gcount());
+	if (bytes % sizeof(T) != 0) {
+		throw std::runtime_error("File size is not a multiple of the record size");
+	}
+	return bytes / sizeof(T);
+}
+
+template<typename T>
+auto write_records(std::fstream & file, T const * const buffer, std::size_t const count) -> void {
+	file.write(reinterpret_cast<char const *>(buffer), static_cast<std::streamsize>(count * sizeof(T)));
+	if (!file) {
+		throw std::runtime_error("Unable to write records");
+	}
+}
+
+template<typename T>
+struct record_reader {
+	record_reader(std::filesystem::path const & path, std::size_t const buffer_size):
+		m_file(::containers::open_file(path, std::ios::in)),
+		m_buffer(buffer_size)
+	{
+		refill();
+	}
+
+	auto is_empty() const -> bool {
+		return m_position == m_size;
+	}
+	auto front() const -> T const & {
+		BOUNDED_ASSERT(!is_empty());
+		return m_buffer.data()[m_position];
+	}
+	auto pop_front() -> void {
+		BOUNDED_ASSERT(!is_empty());
+		++m_position;
+		if (m_position == m_size) {
+			refill();
+		}
+	}
+
+private:
+	auto refill() -> void {
+		m_position = 0;
+		m_size = ::containers::read_records(m_file, m_buffer.data(), m_buffer.capacity());
+	}
+
+	std::fstream m_file;
+	record_buffer<T> m_buffer;
+	std::size_t m_position = 0;
+	std::size_t m_size = 0;
+};
+
+template<typename T>
+struct record_writer {
+	record_writer(std::filesystem::path const & path, std::size_t const buffer_size):
+		m_file(::containers::open_file(path, std::ios::out | std::ios::trunc)),
+		m_buffer(buffer_size)
+	{
+	}
+
+	auto push_back(T const & value) -> void {
+		if (m_size == m_buffer.capacity()) {
+			flush();
+		}
+		std::construct_at(m_buffer.data() + m_size, value);
+		++m_size;
+	}
+	// Must be called to write anything still in the buffer
+	auto flush() -> void {
+		::containers::write_records(m_file, m_buffer.data(), m_size);
+		m_size = 0;
+	}
+
+private:
+	std::fstream m_file;
+	record_buffer<T> m_buffer;
+	std::size_t m_size = 0;
+};
+
+template<typename T>
+auto merge_runs(std::span<temporary_file const> const runs, std::filesystem::path const & output, auto const & radix_key, std::size_t const buffer_size) -> void {
+	auto readers = containers::vector<record_reader<T>>();
+	readers.reserve(::bounded::assume_in_range<range_size_t<containers::vector<record_reader<T>>>>(runs.size()));
+	for (auto const & run : runs) {
+		::containers::push_back(readers, record_reader<T>(run.path, buffer_size));
+	}
+	auto const reader = containers::data(readers);
+
+	// A min-heap of the readers that still have records, by their next key
+	auto heap = containers::vector<std::size_t>();
+	heap.reserve(::bounded::assume_in_range<range_size_t<containers::vector<std::size_t>>>(runs.size()));
+	for (std::size_t index = 0; index != runs.size(); ++index) {
+		if (!reader[index].is_empty()) {
+			::containers::push_back(heap, index);
+		}
+	}
+	auto const heap_begin = containers::data(heap);
+	auto heap_end = heap_begin + static_cast<std::ptrdiff_t>(containers::size(heap));
+	auto const greater = [&](std::size_t const lhs, std::size_t const rhs) {
+		return radix_key(reader[rhs].front()) < radix_key(reader[lhs].front());
+	};
+	std::make_heap(heap_begin, heap_end, greater);
+
+	auto writer = record_writer<T>(output, buffer_size);
+	while (heap_begin != heap_end) {
+		std::pop_heap(heap_begin, heap_end, greater);
+		auto & current = reader[*(heap_end - 1)];
+		writer.push_back(current.front());
+		current.pop_front();
+		if (current.is_empty()) {
+			--heap_end;
+		} else {
+			std::push_heap(heap_begin, heap_end, greater);
+		}
+	}
+	writer.flush();
+}
+
+template<typename T>
+auto external_sort_impl(auto read_input, std::filesystem::path const & output, auto const & extract_key, external_sort_options const & options) -> void {
+	auto const capacity = options.memory_limit / sizeof(T);
+	BOUNDED_ASSERT(capacity != 0);
+	// The runs are sorted and merged by the same key. ska_sort sorts small
+	// ranges with `<` on the key it is given, which is not the radix order for
+	// floating-point keys (-0.0 and 0.0, NaN), so it is given the radix key.
+	auto const radix_key = [&](T const & value) {
+		return to_radix_sort_key(extract_key(value));
+	};
+	auto names = temporary_file_names(options.temporary_directory);
+	auto runs = containers::vector<temporary_file>();
+	{
+		auto buffer = record_buffer<T>(capacity);
+		while (true) {
+			auto const count = read_input(buffer.data(), capacity);
+			auto const first = buffer.data();
+			auto const last = first + static_cast<std::ptrdiff_t>(count);
+			::containers::ska_sort(range_view(first, last), radix_key);
+			if (containers::size(runs) == 0_bi and count != capacity) {
+				// Everything fit in memory, so there is nothing to merge
+				auto file = ::containers::open_file(output, std::ios::out | std::ios::trunc);
+				::containers::write_records(file, first, count);
+				return;
+			}
+			if (count == 0) {
+				break;
+			}
+			::containers::push_back(runs, names.next());
+			auto file = ::containers::open_file(containers::back(runs).path, std::ios::out | std::ios::trunc);
+			::containers::write_records(file, first, count);
+			if (count != capacity) {
+				break;
+			}
+		}
+	}
+
+	auto const buffer_bytes = std::max(options.memory_limit / (containers::size(runs) + 1U), minimum_merge_buffer_bytes);
+	auto const fan_in = std::max(options.memory_limit / buffer_bytes, std::size_t(3)) - 1U;
+	auto const buffer_size = std::max(options.memory_limit / (fan_in + 1U) / sizeof(T), std::size_t(1));
+	while (static_cast<std::size_t>(containers::size(runs)) > fan_in) {
+		auto merged = containers::vector<temporary_file>();
+		auto const all = std::span<temporary_file const>(containers::data(runs), static_cast<std::size_t>(containers::size(runs)));
+		for (std::size_t offset = 0; offset < all.size(); offset += fan_in) {
+			::containers::push_back(merged, names.next());
+			::containers::merge_runs<T>(all.subspan(offset, std::min(fan_in, all.size() - offset)), containers::back(merged).path, radix_key, buffer_size);
+		}
+		runs = std::move(merged);
+	}
+	::containers::merge_runs<T>(
+		std::span<temporary_file const>(containers::data(runs), static_cast<std::size_t>(containers::size(runs))),
+		output,
+		radix_key,
+		buffer_size
+	);
+}
+
+// Writes the records of `input` to `output` in the order ska_sort would put
+// them in. Records are read and written as their bytes, so the input must have
+// been written by a program using the same layout for `T`. At most
+// `options.memory_limit` bytes of records are in memory at once, plus one
+// buffer per run while merging if the limit is very small. Not stable.
+template<external_sortable T>
+struct external_sort_t {
+	static auto operator()(std::filesystem::path const & input, std::filesystem::path const & output, auto const & extract_key, external_sort_options const & options = external_sort_options()) -> void {
+		BOUNDED_ASSERT(!std::filesystem::exists(output) or !std::filesystem::equivalent(input, output));
+		auto file = ::containers::open_file(input, std::ios::in);
+		::containers::external_sort_impl<T>(
+			[&](T * const buffer, std::size_t const max_count) {
+				return ::containers::read_records(file, buffer, max_count);
+			},
+			output,
+			extract_key,
+			options
+		);
+	}
+	static auto operator()(std::span<T const> const input, std::filesystem::path const & output, auto const & extract_key, external_sort_options const & options = external_sort_options()) -> void {
+		auto remaining = input;
+		::containers::external_sort_impl<T>(
+			[&](T * const buffer, std::size_t const max_count) {
+				auto const count = std::min(max_count, remaining.size());
+				std::uninitialized_copy_n(remaining.data(), count, buffer);
+				remaining = remaining.subspan(count);
+				return count;
+			},
+			output,
+			extract_key,
+			options
+		);
+	}
+	static auto operator()(std::filesystem::path const & input, std::filesystem::path const & output, external_sort_options const & options = external_sort_options()) -> void {
+		operator()(input, output, to_radix_sort_key, options);
+	}
+	static auto operator()(std::span<T const> const input, std::filesystem::path const & output, external_sort_options const & options = external_sort_options()) -> void {
+		operator()(input, output, to_radix_sort_key, options);
+	}
+};
+export template<external_sortable T>
+constexpr auto external_sort = external_sort_t<T>();
+
+} // namespace containers
@@ -18,6 +18,8 @@ export module containers.algorithms.sort.inplace_radix_sort;
 
 import containers.algorithms.sort.common_prefix;
 import containers.algorithms.sort.sort;
+import containers.algorithms.sort.sort_tuning;
+import containers.algorithms.sort.sorting_network;
 import containers.algorithms.sort.to_radix_sort_key;
 
 import containers.algorithms.advance;
@@ -30,6 +32,7 @@ import containers.front_back;
 import containers.index_type;
 import containers.is_range;
 import containers.iter_difference_t;
+import containers.range_value_t;
 import containers.range_view;
 import containers.size;
 
@@ -62,7 +65,7 @@ struct BaseListSortData {
 };
 
 template<view View, typename ExtractKey>
-using NextSort = void (&)(View, ExtractKey const &, BaseListSortData *);
+using NextSort = void (&)(View, ExtractKey const &, sort_tuning, BaseListSortData *);
 
 template<view View, typename ExtractKey>
 struct ListSortData : BaseListSortData {
@@ -166,12 +169,12 @@ struct PartitionCounts {
 	int number = 0;
 };
 
-template<std::ptrdiff_t std_sort_threshold, std::ptrdiff_t american_flag_sort_threshold, typename CurrentSubKey, std::size_t number_of_bytes>
+template<typename CurrentSubKey, std::size_t number_of_bytes>
 struct UnsignedInplaceSorter {
 	// Must have this exact signature, no defaulted arguments
 	template<view View, typename ExtractKey>
-	static constexpr void sort(View to_sort, ExtractKey const & extract_key, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data) {
-		sort_selector(to_sort, extract_key, next_sort, sort_data, 0U);
+	static constexpr void sort(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data) {
+		sort_selector(to_sort, extract_key, tuning, next_sort, sort_data, 0U);
 	}
 private:
 
@@ -201,19 +204,36 @@ private:
 	}
 
 	template<view View, typename ExtractKey>
-	static constexpr void sort_selector(View to_sort, ExtractKey const & extract_key, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data, std::size_t const offset) {
+	static constexpr void sort_selector(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data, std::size_t const offset) {
 		if (number_of_bytes == offset) {
-			next_sort(to_sort, extract_key, sort_data);
-		} else if (containers::size(to_sort) <= bounded::constant<std_sort_threshold>) {
-			containers::sort(to_sort, extract_key_to_less(extract_key));
-		} else if (containers::size(to_sort) < bounded::constant<american_flag_sort_threshold>) {
-			american_flag_sort(to_sort, extract_key, next_sort, sort_data, offset);
+			next_sort(to_sort, extract_key, tuning, sort_data);
+		} else if (containers::size(to_sort) <= tuning.std_sort_threshold) {
+			small_sort(to_sort, extract_key);
+		} else if (containers::size(to_sort) < tuning.american_flag_sort_threshold) {
+			american_flag_sort(to_sort, extract_key, tuning, next_sort, sort_data, offset);
 		} else {
-			ska_byte_sort(to_sort, extract_key, next_sort, sort_data, offset);
+			ska_byte_sort(to_sort, extract_key, tuning, next_sort, sort_data, offset);
+		}
+	}
+	// Integers sort the same by value as by their radix key, so small buckets
+	// of them can use a sorting network.
+	template<view View, typename ExtractKey>
+	static constexpr void small_sort(View to_sort, ExtractKey const & extract_key) {
+		if constexpr (
+			(std::same_as<ExtractKey, to_radix_sort_key_t> or std::same_as<ExtractKey, std::identity>) and
+			std::integral<range_value_t<View>> and
+			network_sortable<View, std::less<>> and
+			prefer_network_sort<range_value_t<View>>
+		) {
+			if (containers::size(to_sort) <= max_network_sort_size) {
+				::containers::network_sort(to_sort);
+				return;
+			}
 		}
+		containers::sort(to_sort, extract_key_to_less(extract_key));
 	}
 	template<view View, typename ExtractKey>
-	static constexpr void american_flag_sort(View to_sort, ExtractKey const & extract_key, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data, std::size_t const offset) {
+	static constexpr void american_flag_sort(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data, std::size_t const offset) {
 		auto partitions = partition_counts(to_sort, extract_key, sort_data, offset);
 		auto const first = containers::begin(to_sort);
 		using difference_type = iter_difference_t<decltype(first)>;
@@ -260,6 +280,7 @@ private:
 				sort_selector(
 					range_view(partition_begin, partition_end),
 					extract_key,
+					tuning,
 					next_sort,
 					sort_data,
 					offset + 1U
@@ -270,7 +291,7 @@ private:
 	}
 
 	template<view View, typename ExtractKey>
-	static constexpr void ska_byte_sort(View to_sort, ExtractKey const & extract_key, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data, std::size_t const offset) {
+	static constexpr void ska_byte_sort(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data, std::size_t const offset) {
 		auto partitions = partition_counts(to_sort, extract_key, sort_data, offset);
 		auto const first = containers::begin(to_sort);
 		using difference_type = iter_difference_t<decltype(first)>;
@@ -304,6 +325,7 @@ private:
 				sort_selector(
 					range_view(partition_begin, partition_end),
 					extract_key,
+					tuning,
 					next_sort,
 					sort_data,
 					offset + 1U
@@ -313,35 +335,37 @@ private:
 	}
 };
 
-template<std::ptrdiff_t std_sort_threshold, std::ptrdiff_t american_flag_sort_threshold, typename CurrentSubKey, typename SubKeyType>
+template<typename CurrentSubKey, typename SubKeyType>
 struct ListInplaceSorter;
 
-template<std::ptrdiff_t std_sort_threshold, std::ptrdiff_t american_flag_sort_threshold, typename CurrentSubKey, view View, typename ExtractKey>
-constexpr void inplace_sort(View to_sort, ExtractKey const & extract_key, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data) {
+template<typename CurrentSubKey, view View, typename ExtractKey>
+constexpr void inplace_sort(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, NextSort<View, ExtractKey> next_sort, BaseListSortData * sort_data) {
 	using SubKeyType = decltype(CurrentSubKey::sub_key(extract_key(containers::front(to_sort)), sort_data));
 	if constexpr (std::same_as<SubKeyType, bool>) {
 		auto middle = containers::partition(to_sort, [&](auto && a){ return !CurrentSubKey::sub_key(extract_key(a), sort_data); });
 		next_sort(
 			range_view(containers::begin(to_sort), middle),
 			extract_key,
+			tuning,
 			sort_data
 		);
 		next_sort(
 			range_view(middle, containers::end(to_sort)),
 			extract_key,
+			tuning,
 			sort_data
 		);
 	} else if constexpr (bounded::unsigned_builtin<SubKeyType>) {
-		UnsignedInplaceSorter<std_sort_threshold, american_flag_sort_threshold, CurrentSubKey, sizeof(SubKeyType)>::sort(to_sort, extract_key, next_sort, sort_data);
+		UnsignedInplaceSorter<CurrentSubKey, sizeof(SubKeyType)>::sort(to_sort, extract_key, tuning, next_sort, sort_data);
 	} else {
-		ListInplaceSorter<std_sort_threshold, american_flag_sort_threshold, CurrentSubKey, SubKeyType>::sort(to_sort, extract_key, next_sort, sort_data);
+		ListInplaceSorter<CurrentSubKey, SubKeyType>::sort(to_sort, extract_key, tuning, next_sort, sort_data);
 	}
 }
 
-template<std::ptrdiff_t std_sort_threshold, std::ptrdiff_t american_flag_sort_threshold, typename CurrentSubKey, typename ListType>
+template<typename CurrentSubKey, typename ListType>
 struct ListInplaceSorter {
 	template<view View, typename ExtractKey>
-	static constexpr void sort(View to_sort, ExtractKey const & extract_key, NextSort<View, ExtractKey> next_sort, BaseListSortData * next_sort_data) {
+	static constexpr void sort(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, NextSort<View, ExtractKey> next_sort, BaseListSortData * next_sort_data) {
 		constexpr auto current_index = 0U;
 		constexpr auto recursion_limit = 16U;
 		auto const offset = ListSortData<View, ExtractKey>{
@@ -352,7 +376,7 @@ struct ListInplaceSorter {
 			},
 			next_sort,
 		};
-		sort(to_sort, extract_key, offset);
+		sort(to_sort, extract_key, tuning, offset);
 	}
 
 private:
@@ -371,7 +395,7 @@ private:
 	};
 
 	template<view View, typename ExtractKey>
-	static constexpr void sort(View to_sort, ExtractKey const & extract_key, ListSortData<View, ExtractKey> sort_data) {
+	static constexpr void sort(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, ListSortData<View, ExtractKey> sort_data) {
 		auto current_key = [&](auto const & elem) -> decltype(auto) {
 			return CurrentSubKey::sub_key(extract_key(elem), sort_data.next_sort_data);
 		};
@@ -393,13 +417,15 @@ private:
 			sort_data.next_sort(
 				range_view(first, end_of_shorter_ones),
 				extract_key,
+				tuning,
 				sort_data.next_sort_data
 			);
 		}
 		if (last - end_of_shorter_ones > bounded::constant<1>) {
-			inplace_sort<std_sort_threshold, american_flag_sort_threshold, ElementSubKey>(
+			inplace_sort<ElementSubKey>(
 				range_view(end_of_shorter_ones, last),
 				extract_key,
+				tuning,
 				static_cast<NextSort<View, ExtractKey>>(sort_from_recursion),
 				std::addressof(sort_data)
 			);
@@ -407,38 +433,43 @@ private:
 	}
 
 	template<view View, typename ExtractKey>
-	static constexpr void sort_from_recursion(View to_sort, ExtractKey const & extract_key, BaseListSortData * next_sort_data) {
+	static constexpr void sort_from_recursion(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, BaseListSortData * next_sort_data) {
 		auto offset = *static_cast<ListSortData<View, ExtractKey> *>(next_sort_data);
 		++offset.current_index;
 		--offset.recursion_limit;
 		if (offset.recursion_limit == 0) {
 			containers::sort(to_sort, extract_key_to_less(extract_key));
 		} else {
-			sort(to_sort, extract_key, offset);
+			sort(to_sort, extract_key, tuning, offset);
 		}
 	}
 };
 
-template<std::ptrdiff_t std_sort_threshold, std::ptrdiff_t american_flag_sort_threshold, typename CurrentSubKey, view View, typename ExtractKey>
-constexpr void sort_starter(View to_sort, ExtractKey const & extract_key, BaseListSortData * next_sort_data) {
+template<typename CurrentSubKey, view View, typename ExtractKey>
+constexpr void sort_starter(View to_sort, ExtractKey const & extract_key, sort_tuning const tuning, BaseListSortData * next_sort_data) {
 	if constexpr (!std::same_as<CurrentSubKey, SubKey<void>>) {
 		if (containers::size(to_sort) <= bounded::constant<1>) {
 			return;
 		}
 
-		inplace_sort<std_sort_threshold, american_flag_sort_threshold, CurrentSubKey>(
+		inplace_sort<CurrentSubKey>(
 			to_sort,
 			extract_key,
-			static_cast<NextSort<View, ExtractKey>>(sort_starter<std_sort_threshold, american_flag_sort_threshold, typename CurrentSubKey::next>),
+			tuning,
+			static_cast<NextSort<View, ExtractKey>>(sort_starter<typename CurrentSubKey::next>),
 			next_sort_data
 		);
 	}
 }
 
+export constexpr void inplace_radix_sort(view auto to_sort, auto const & extract_key, sort_tuning const tuning) {
+	using SubKey = SubKey<decltype(extract_key(containers::front(to_sort)))>;
+	sort_starter<SubKey>(to_sort, extract_key, tuning, nullptr);
+}
+
 export template<std::ptrdiff_t std_sort_threshold, std::ptrdiff_t american_flag_sort_threshold>
 constexpr void inplace_radix_sort(view auto to_sort, auto const & extract_key) {
-	using SubKey = SubKey<decltype(extract_key(containers::front(to_sort)))>;
-	sort_starter<std_sort_threshold, american_flag_sort_threshold, SubKey>(to_sort, extract_key, nullptr);
+	::containers::inplace_radix_sort(to_sort, extract_key, sort_tuning(std_sort_threshold, american_flag_sort_threshold));
 }
 
 } // namespace containers
@@ -0,0 +1,105 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+export module containers.algorithms.sort.key_cached_sort;
+
+import containers.algorithms.sort.sort_permutation;
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.test_sort_inplace_and_relocate;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.array;
+import containers.index_type;
+import containers.is_range;
+import containers.range_value_t;
+import containers.size;
+import containers.vector;
+
+import bounded;
+import numeric_traits;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+// A radix sort calls extract_key several times for each element: once per
+// pass to count, once per pass to place, and again in the small sort at the
+// bottom. That is free when extract_key just reads a value, but an extractor
+// that computes its key, such as a hash or a lookup through a pointer, pays
+// for it on every call. Specialize this for such extractors.
+export template<typename ExtractKey>
+constexpr auto is_expensive_key_extractor = false;
+
+// Below this size the extra allocation costs more than the saved calls.
+export constexpr auto key_cached_sort_minimum_size = 128_bi;
+
+// Caching also pays off when an element is bigger than a key and an index,
+// because each element is then moved once instead of once per pass.
+export template<typename Range, typename ExtractKey>
+constexpr auto prefer_key_cached_sort =
+	key_cacheable<Range, ExtractKey> and
+	(
+		is_expensive_key_extractor<ExtractKey> or
+		sizeof(range_value_t<Range>) > sizeof(extracted_key_t<Range, ExtractKey>) + sizeof(index_type<Range>)
+	) and
+	numeric_traits::max_value<range_size_t<Range>> >= key_cached_sort_minimum_size;
+
+// Calls extract_key exactly once per element, sorts the (key, index) pairs,
+// and then moves each element directly to its final position. Not stable.
+struct key_cached_sort_t {
+	template<typename Range, typename ExtractKey> requires key_cacheable<Range, ExtractKey>
+	static constexpr auto operator()(Range && to_sort, ExtractKey const & extract_key) -> void {
+		::containers::apply_permutation_inplace(to_sort, ::containers::sort_permutation(to_sort, extract_key));
+	}
+	template<typename Range> requires key_cacheable<Range, to_radix_sort_key_t>
+	static constexpr auto operator()(Range && to_sort) -> void {
+		operator()(to_sort, to_radix_sort_key);
+	}
+};
+export constexpr auto key_cached_sort = key_cached_sort_t();
+
+} // namespace containers
+
+using namespace containers_test;
+
+constexpr auto key_cached_sort_by_copy = [](auto & to_sort) {
+	containers::key_cached_sort(to_sort, default_copy);
+};
+
+static_assert(test_sort(uint8_1, key_cached_sort_by_copy));
+static_assert(test_sort(uint8_2, key_cached_sort_by_copy));
+static_assert(test_sort(uint8_3, key_cached_sort_by_copy));
+static_assert(test_sort(containers::array{uint8_many}, key_cached_sort_by_copy));
+static_assert(test_sort(containers::array{uint8_256}, key_cached_sort_by_copy));
+static_assert(test_sort(containers::array{uint16_many}, key_cached_sort_by_copy));
+static_assert(test_sort(containers::array{uint32_many}, key_cached_sort_by_copy));
+static_assert(test_sort(containers::array{uint64_many}, key_cached_sort_by_copy));
+static_assert(test_sort(array_uint8_1_2, key_cached_sort_by_copy));
+static_assert(test_sort(array_uint8_1_3_two_values, key_cached_sort_by_copy));
+static_assert(test_sort(containers::array{make_move_only()}, key_cached_sort_by_copy));
+
+struct expensive_key {
+	static constexpr auto operator()(int const value) -> int {
+		return value;
+	}
+};
+
+template<>
+constexpr auto containers::is_expensive_key_extractor<expensive_key> = true;
+
+struct large_element {
+	int key;
+	containers::array<int, 15_bi> data;
+};
+
+constexpr auto get_large_element_key = [](large_element const & value) { return value.key; };
+
+static_assert(!containers::prefer_key_cached_sort<containers::vector<int>, decltype(default_copy)>);
+static_assert(!containers::prefer_key_cached_sort<containers::vector<int>, containers::to_radix_sort_key_t>);
+static_assert(containers::prefer_key_cached_sort<containers::vector<int>, expensive_key>);
+static_assert(containers::prefer_key_cached_sort<containers::vector<large_element>, decltype(get_large_element_key)>);
+static_assert(!containers::prefer_key_cached_sort<containers::array<int, 4_bi>, decltype(default_copy)>);
+static_assert(!containers::key_cacheable<containers::vector<int>, decltype([](int const & value) -> int const & { return value; })>);
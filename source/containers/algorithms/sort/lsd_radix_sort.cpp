@@ -0,0 +1,117 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.algorithms.sort.lsd_radix_sort;
+
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.array;
+import containers.begin_end;
+import containers.front_back;
+import containers.index_type;
+import containers.integer_range;
+import containers.is_range;
+import containers.size;
+
+import bounded;
+import numeric_traits;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+// Least significant digit first radix sort for keys that convert to a single
+// unsigned integer. All of the byte histograms are computed in one pass over
+// the input, and any byte that has the same value in every key is skipped, so
+// keys that only use their low bits cost only as many scatters as they need.
+
+template<typename Range, typename ExtractKey>
+concept lsd_radix_sortable = range<Range> and bounded::unsigned_builtin<std::decay_t<decltype(to_radix_sort_key(
+	bounded::declval<ExtractKey const &>()(containers::front(bounded::declval<Range &>()))
+))>>;
+
+constexpr auto radix_byte(auto const key, auto const index) {
+	return (bounded::integer(key) >> (index * 8_bi)) % 256_bi;
+}
+
+template<range Source, range Destination>
+constexpr auto lsd_scatter(Source & source, Destination & destination, auto & offsets, auto const index, auto const & extract_key) -> void {
+	for (auto && value : source) {
+		auto & offset = offsets[::containers::radix_byte(to_radix_sort_key(extract_key(value)), index)];
+		destination[::bounded::assume_in_range<index_type<Destination>>(offset)] = std::move(value);
+		++offset;
+	}
+}
+
+template<range Source, range Buffer, typename ExtractKey>
+constexpr auto lsd_radix_sort_impl(Source & source, Buffer & buffer, ExtractKey const & extract_key) -> bool {
+	if (containers::size(source) == 0_bi) {
+		return false;
+	}
+	using key_t = std::decay_t<decltype(to_radix_sort_key(extract_key(containers::front(source))))>;
+	constexpr auto key_size = bounded::size_of<key_t>;
+	auto const index_range = integer_range(key_size);
+
+	auto counts = containers::array<std::size_t, key_size, 256_bi>();
+	for (auto const & value : source) {
+		auto const key = to_radix_sort_key(extract_key(value));
+		for (auto const index : index_range) {
+			++counts[index][::containers::radix_byte(key, index)];
+		}
+	}
+
+	auto const total = static_cast<std::size_t>(containers::size(source));
+	auto const first_key = to_radix_sort_key(extract_key(containers::front(source)));
+	auto is_constant = containers::array<bool, key_size>();
+	for (auto const index : index_range) {
+		auto & count = counts[index];
+		is_constant[index] = count[::containers::radix_byte(first_key, index)] == total;
+		auto offset = std::size_t(0);
+		for (auto const i : containers::integer_range(256_bi)) {
+			offset += std::exchange(count[i], offset);
+		}
+	}
+
+	auto in_buffer = false;
+	for (auto const index : index_range) {
+		if (is_constant[index]) {
+			continue;
+		}
+		if (in_buffer) {
+			::containers::lsd_scatter(buffer, source, counts[index], index, extract_key);
+		} else {
+			::containers::lsd_scatter(source, buffer, counts[index], index, extract_key);
+		}
+		in_buffer = !in_buffer;
+	}
+	return in_buffer;
+}
+
+// Sorts `source`, using `buffer` as scratch space. `buffer` must be the same
+// size as `source`. Returns whether the sorted result is in `buffer`.
+struct lsd_radix_sort_t {
+	template<range Source, range Buffer, typename ExtractKey> requires lsd_radix_sortable<Source, ExtractKey>
+	static constexpr auto operator()(Source && source, Buffer && buffer, ExtractKey const & extract_key) -> bool {
+		if constexpr (numeric_traits::max_value<range_size_t<Source>> <= bounded::constant<1>) {
+			return false;
+		} else {
+			BOUNDED_ASSERT(containers::size(source) == containers::size(buffer));
+			return ::containers::lsd_radix_sort_impl(source, buffer, extract_key);
+		}
+	}
+
+	template<range Source, range Buffer> requires lsd_radix_sortable<Source, to_radix_sort_key_t>
+	static constexpr auto operator()(Source && source, Buffer && buffer) -> bool {
+		return operator()(source, buffer, to_radix_sort_key);
+	}
+};
+export constexpr auto lsd_radix_sort = lsd_radix_sort_t();
+
+} // namespace containers
@@ -0,0 +1,168 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.algorithms.sort.nth_element;
+
+import containers.algorithms.sort.quicksort_partition;
+import containers.algorithms.sort.sort;
+import containers.algorithms.sort.sort_test_data;
+
+import containers.algorithms.advance;
+import containers.algorithms.compare;
+import containers.array;
+import containers.begin_end;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.range_view;
+import containers.size;
+
+import bounded;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+// Quickselect with the same partitioning as new_sort, but only continuing into
+// the side that contains `nth`. Small ranges, and ranges that keep
+// partitioning badly, are sorted instead.
+template<typename Iterator>
+constexpr auto nth_element_impl(Iterator first, Iterator last, Iterator const nth, auto const compare) -> void {
+	auto sort_remaining = [&] {
+		auto remaining = range_view(first, last);
+		::containers::new_sort(remaining, compare);
+	};
+	auto bad_partitions_allowed = std::bit_width(static_cast<std::size_t>(last - first));
+	auto leftmost = true;
+	while (true) {
+		auto const size = last - first;
+		if (size < insertion_sort_threshold) {
+			sort_remaining();
+			return;
+		}
+		::containers::choose_pivot(first, last, size, compare);
+		if (!leftmost and !compare(*containers::prev(first), *first)) {
+			auto const equal_end = ::containers::partition_left(first, last, compare);
+			if (nth <= equal_end) {
+				return;
+			}
+			first = containers::next(equal_end);
+			continue;
+		}
+		auto const pivot = ::containers::partition_right(first, last, compare).pivot;
+		auto const left_size = pivot - first;
+		auto const right_size = last - containers::next(pivot);
+		if (left_size < size / 8_bi or right_size < size / 8_bi) {
+			--bad_partitions_allowed;
+			if (bad_partitions_allowed == 0) {
+				sort_remaining();
+				return;
+			}
+			::containers::break_patterns(first, pivot);
+			::containers::break_patterns(containers::next(pivot), last);
+		}
+		if (nth < pivot) {
+			last = pivot;
+		} else if (pivot < nth) {
+			first = containers::next(pivot);
+			leftmost = false;
+		} else {
+			return;
+		}
+	}
+}
+
+constexpr auto iterator_at(range auto && r, auto const index) {
+	auto const first = containers::begin(r);
+	return first + ::bounded::assume_in_range<iter_difference_t<decltype(first)>>(index);
+}
+
+// Puts the element that would be at `index` in a sorted range at `index`, with
+// nothing greater before it and nothing less after it
+struct nth_element_t {
+	static constexpr auto operator()(range auto && to_sort, auto const index, auto const compare) -> void {
+		BOUNDED_ASSERT(index < containers::size(to_sort));
+		::containers::nth_element_impl(
+			containers::begin(to_sort),
+			containers::end(to_sort),
+			::containers::iterator_at(to_sort, index),
+			compare
+		);
+	}
+	static constexpr auto operator()(range auto && to_sort, auto const index) -> void {
+		operator()(to_sort, index, std::less());
+	}
+};
+export constexpr auto nth_element = nth_element_t();
+
+// Sorts the smallest `count` elements into the front of the range. The order
+// of the rest is unspecified.
+struct partial_sort_t {
+	static constexpr auto operator()(range auto && to_sort, auto const count, auto const compare) -> void {
+		BOUNDED_ASSERT(count <= containers::size(to_sort));
+		if (count == 0_bi) {
+			return;
+		}
+		auto const first = containers::begin(to_sort);
+		auto const last_sorted = containers::prev(::containers::iterator_at(to_sort, count));
+		::containers::nth_element_impl(first, containers::end(to_sort), last_sorted, compare);
+		auto before = range_view(first, last_sorted);
+		::containers::new_sort(before, compare);
+	}
+	static constexpr auto operator()(range auto && to_sort, auto const count) -> void {
+		operator()(to_sort, count, std::less());
+	}
+};
+export constexpr auto partial_sort = partial_sort_t();
+
+} // namespace containers
+
+using namespace containers_test;
+
+constexpr auto test_indexes = containers::array{0, 1, 23, 24, 25, 100, 198, 199};
+
+constexpr auto test_nth_element(auto data) -> bool {
+	for (auto const index : test_indexes) {
+		auto input = data.input;
+		containers::nth_element(input, index);
+		auto const nth = ::containers::iterator_at(input, index);
+		BOUNDED_ASSERT(*nth == *::containers::iterator_at(data.expected, index));
+		for (auto it = containers::begin(input); it != nth; ++it) {
+			BOUNDED_ASSERT(*it <= *nth);
+		}
+		for (auto it = nth; it != containers::end(input); ++it) {
+			BOUNDED_ASSERT(*nth <= *it);
+		}
+	}
+	return true;
+}
+
+constexpr auto test_partial_sort(auto data) -> bool {
+	for (auto const index : test_indexes) {
+		auto input = data.input;
+		containers::partial_sort(input, index);
+		auto const middle = ::containers::iterator_at(input, index);
+		BOUNDED_ASSERT(containers::equal(containers::begin(input), middle, containers::begin(data.expected)));
+	}
+	return true;
+}
+
+static_assert([] {
+	for (auto const & data : int_patterns) {
+		BOUNDED_ASSERT(test_nth_element(data));
+		BOUNDED_ASSERT(test_partial_sort(data));
+	}
+	return true;
+}());
+
+static_assert([] {
+	auto values = containers::array{5, 3, 1, 4, 2};
+	containers::nth_element(values, 2_bi, std::greater());
+	return values[2_bi] == 3;
+}());
@@ -0,0 +1,164 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Parallel version of ska_sort. The most significant byte that is not the
+// same in every key is histogrammed and scattered by all threads at once,
+// which splits the input into 256 independent buckets. Those buckets are then
+// sorted concurrently by the single-threaded ska_sort.
+
+export module containers.algorithms.sort.parallel_ska_sort;
+
+import containers.algorithms.sort.ska_sort;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.parallel_for_each_index;
+import containers.begin_end;
+import containers.data;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.range_value_t;
+import containers.range_view;
+import containers.repeat_n;
+import containers.size;
+import containers.uninitialized_dynamic_array;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+template<typename Range, typename ExtractKey>
+concept parallel_radix_sortable =
+	random_access_range<Range> and
+	bounded::unsigned_builtin<std::decay_t<decltype(to_radix_sort_key(
+		bounded::declval<ExtractKey const &>()(bounded::declval<range_value_t<Range> const &>())
+	))>>;
+
+// Below this size, starting threads costs more than it saves
+constexpr auto parallel_sort_minimum_size = bounded::constant<1 << 16>;
+
+using histogram = std::array<std::size_t, 256>;
+
+constexpr auto byte_at(auto const & value, auto const & extract_key, unsigned const shift) -> std::uint8_t {
+	return static_cast<std::uint8_t>(to_radix_sort_key(extract_key(value)) >> shift);
+}
+
+template<typename View>
+auto parallel_radix_sort(View const to_sort, auto const & extract_key, thread_count_t const threads) -> void {
+	using value_type = range_value_t<View>;
+	auto const first = containers::begin(to_sort);
+	using difference_type = iter_difference_t<decltype(first)>;
+	auto const size = static_cast<std::size_t>(containers::size(to_sort));
+	auto const chunk_count = static_cast<std::size_t>(threads);
+	auto chunk = [&](std::size_t const index) {
+		auto offset = [&](std::size_t const n) {
+			return first + ::bounded::assume_in_range<difference_type>(size * n / chunk_count);
+		};
+		return range_view(offset(index), offset(index + 1U));
+	};
+
+	// Keys often share their high bytes, for instance small numbers in a wide
+	// type. Splitting on such a byte would put everything in one bucket, so
+	// find the first byte that is not the same in every key.
+	using key_t = std::decay_t<decltype(to_radix_sort_key(extract_key(*first)))>;
+	auto const first_key = to_radix_sort_key(extract_key(*first));
+	auto differences = containers::vector<key_t>(containers::repeat_default_n<key_t>(threads));
+	auto const differences_data = containers::data(differences);
+	::containers::parallel_for_each_index(threads, chunk_count, [&](std::size_t const index) {
+		auto difference = key_t(0);
+		for (auto const & value : chunk(index)) {
+			difference |= static_cast<key_t>(to_radix_sort_key(extract_key(value)) ^ first_key);
+		}
+		differences_data[index] = difference;
+	});
+	auto varying_bits = key_t(0);
+	for (auto const difference : differences) {
+		varying_bits |= difference;
+	}
+	if (varying_bits == 0U) {
+		// Every key is the same
+		return;
+	}
+	auto const shift = static_cast<unsigned>(std::bit_width(varying_bits) - 1) / 8U * 8U;
+
+	// counts[chunk][byte] starts out as the number of elements in that chunk
+	// with that byte, and then becomes the position that chunk writes its next
+	// element with that byte to.
+	auto counts = containers::vector<histogram>(containers::repeat_default_n<histogram>(threads));
+	auto const counts_data = containers::data(counts);
+	::containers::parallel_for_each_index(threads, chunk_count, [&](std::size_t const index) {
+		auto & count = counts_data[index];
+		for (auto const & value : chunk(index)) {
+			++count[byte_at(value, extract_key, shift)];
+		}
+	});
+
+	auto bucket_offsets = std::array<std::size_t, 257>();
+	std::size_t total = 0;
+	for (std::size_t byte = 0; byte != 256; ++byte) {
+		bucket_offsets[byte] = total;
+		for (std::size_t index = 0; index != chunk_count; ++index) {
+			total += std::exchange(counts_data[index][byte], total);
+		}
+	}
+	bucket_offsets[256] = total;
+
+	auto buffer = containers::uninitialized_dynamic_array<value_type, range_size_t<View>>(containers::size(to_sort));
+	auto const buffer_data = buffer.data();
+	::containers::parallel_for_each_index(threads, chunk_count, [&](std::size_t const index) {
+		auto & offsets = counts_data[index];
+		for (auto & value : chunk(index)) {
+			auto & offset = offsets[byte_at(value, extract_key, shift)];
+			bounded::relocate_at(buffer_data[offset], value);
+			++offset;
+		}
+	});
+
+	// Start the largest buckets first so that one large bucket does not end up
+	// running alone at the end
+	auto order = std::array<std::uint8_t, 256>();
+	std::iota(order.begin(), order.end(), std::uint8_t(0));
+	auto bucket_size = [&](std::uint8_t const byte) {
+		return bucket_offsets[byte + 1U] - bucket_offsets[byte];
+	};
+	std::ranges::sort(order, std::greater(), bucket_size);
+	::containers::parallel_for_each_index(threads, order.size(), [&](std::size_t const index) {
+		auto const byte = order[index];
+		auto const bucket_first = bucket_offsets[byte];
+		auto const bucket_last = bucket_offsets[byte + 1U];
+		auto const destination = first + ::bounded::assume_in_range<difference_type>(bucket_first);
+		auto it = destination;
+		for (auto position = bucket_first; position != bucket_last; ++position) {
+			bounded::relocate_at(*it, buffer_data[position]);
+			++it;
+		}
+		::containers::ska_sort(range_view(destination, it), extract_key);
+	});
+}
+
+struct parallel_ska_sort_t {
+	static auto operator()(range auto && to_sort, auto const & extract_key, thread_count_t const threads) -> void {
+		auto const view = range_view(containers::begin(to_sort), containers::end(to_sort));
+		if constexpr (parallel_radix_sortable<decltype(view), decltype(extract_key)>) {
+			if (threads != 1_bi and containers::size(view) >= parallel_sort_minimum_size) {
+				::containers::parallel_radix_sort(view, extract_key, threads);
+				return;
+			}
+		}
+		::containers::ska_sort(view, extract_key);
+	}
+	static auto operator()(range auto && to_sort, auto const & extract_key) -> void {
+		operator()(to_sort, extract_key, default_thread_count());
+	}
+	static auto operator()(range auto && to_sort) -> void {
+		operator()(to_sort, to_radix_sort_key);
+	}
+};
+export constexpr auto parallel_ska_sort = parallel_ska_sort_t();
+
+} // namespace containers
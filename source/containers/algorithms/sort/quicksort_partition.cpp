@@ -0,0 +1,279 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// The partitioning steps of pattern-defeating quicksort
+// (https://arxiv.org/abs/2106.05123), shared by new_sort and nth_element
+
+export module containers.algorithms.sort.quicksort_partition;
+
+import containers.algorithms.sort.cheaply_sortable;
+import containers.algorithms.sort.sort_exactly_3;
+
+import containers.algorithms.advance;
+import containers.array;
+import containers.data;
+
+import bounded;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+// Ranges smaller than this are sorted by insertion sort instead of partitioned
+export constexpr auto insertion_sort_threshold = 24_bi;
+constexpr auto ninther_threshold = 128_bi;
+
+// Moves the pivot to the front of the range. This also guarantees that there
+// is an element that is not less than the pivot after it, so partition_right
+// can scan forward without a bounds check.
+export constexpr auto choose_pivot(auto const first, auto const last, auto const size, auto const compare) -> void {
+	auto const median = first + size / 2_bi;
+	auto const before_last = containers::prev(last);
+	auto sort_three = [&](auto const a, auto const b, auto const c) {
+		::containers::sort_exactly_n_impl(*a, *b, *c, compare);
+	};
+	if (size > ninther_threshold) {
+		sort_three(first, median, before_last);
+		sort_three(first + 1_bi, median - 1_bi, before_last - 1_bi);
+		sort_three(first + 2_bi, median + 1_bi, before_last - 2_bi);
+		sort_three(median - 1_bi, median, median + 1_bi);
+		std::ranges::swap(*first, *median);
+	} else {
+		sort_three(median, first, before_last);
+	}
+}
+
+template<typename Iterator>
+struct partition_result {
+	Iterator pivot;
+	bool already_partitioned;
+};
+
+// This is the branchless partitioning from "BlockQuicksort: How Branch
+// Mispredictions don't affect Quicksort" (https://arxiv.org/abs/1604.06697),
+// as refined by pdqsort. Instead of stopping at each element that is on the
+// wrong side, it compares a block of elements at a time and records the
+// offsets of the ones that need to move. The only branch in that loop is the
+// loop condition, and the swaps are then done in a batch.
+constexpr auto partition_block_size = 64_bi;
+using partition_offsets = containers::array<std::uint8_t, partition_block_size>;
+
+// Swaps the elements at `left_base + left_offsets[n]` and
+// `right_base - right_offsets[n]`. When there are different numbers of
+// elements on each side, this is done as a single cycle, which needs fewer
+// moves than separate swaps.
+constexpr auto swap_offsets(
+	auto const left_base,
+	auto const right_base,
+	std::uint8_t const * const left_offsets,
+	std::uint8_t const * const right_offsets,
+	std::size_t const count,
+	bool const use_swaps
+) -> void {
+	auto left_at = [&](std::size_t const index) {
+		return left_base + bounded::integer(left_offsets[index]);
+	};
+	auto right_at = [&](std::size_t const index) {
+		return right_base - bounded::integer(right_offsets[index]);
+	};
+	if (use_swaps) {
+		// Reverse sorted inputs swap every element, and a cycle would not put
+		// them in order.
+		for (auto index = std::size_t(0); index != count; ++index) {
+			std::ranges::swap(*left_at(index), *right_at(index));
+		}
+	} else if (count != 0) {
+		auto left = left_at(0);
+		auto right = right_at(0);
+		auto temp = std::move(*left);
+		*left = std::move(*right);
+		for (auto index = std::size_t(1); index != count; ++index) {
+			left = left_at(index);
+			*right = std::move(*left);
+			right = right_at(index);
+			*left = std::move(*right);
+		}
+		*right = std::move(temp);
+	}
+}
+
+// Partitions [left, right) around `pivot`, returning the first element that is
+// not less than the pivot. There must be such an element before `left` and an
+// element less than the pivot after `right`.
+template<typename Iterator>
+constexpr auto block_partition(Iterator left, Iterator right, auto const & pivot, auto const compare) -> Iterator {
+	auto left_offsets = partition_offsets();
+	auto right_offsets = partition_offsets();
+	auto left_base = left;
+	auto right_base = right;
+	auto left_count = std::size_t(0);
+	auto right_count = std::size_t(0);
+	auto left_start = std::size_t(0);
+	auto right_start = std::size_t(0);
+	constexpr auto block_size = static_cast<std::size_t>(partition_block_size);
+	while (left < right) {
+		// Fill whichever blocks are empty, splitting the remaining elements
+		// between them if both are
+		auto const unknown = static_cast<std::size_t>(right - left);
+		auto const left_split = left_count == 0 ? (right_count == 0 ? unknown / 2 : unknown) : 0;
+		auto const right_split = right_count == 0 ? unknown - left_split : 0;
+		for (auto index = std::size_t(0); index != std::min(left_split, block_size); ++index) {
+			containers::data(left_offsets)[left_count] = static_cast<std::uint8_t>(index);
+			left_count += !compare(*left, pivot);
+			++left;
+		}
+		for (auto index = std::size_t(0); index != std::min(right_split, block_size); ++index) {
+			--right;
+			containers::data(right_offsets)[right_count] = static_cast<std::uint8_t>(index + 1);
+			right_count += compare(*right, pivot);
+		}
+		auto const count = std::min(left_count, right_count);
+		::containers::swap_offsets(
+			left_base,
+			right_base,
+			containers::data(left_offsets) + left_start,
+			containers::data(right_offsets) + right_start,
+			count,
+			left_count == right_count
+		);
+		left_count -= count;
+		right_count -= count;
+		left_start += count;
+		right_start += count;
+		if (left_count == 0) {
+			left_start = 0;
+			left_base = left;
+		}
+		if (right_count == 0) {
+			right_start = 0;
+			right_base = right;
+		}
+	}
+	// Only one side can have elements left over. They go next to the boundary.
+	if (left_count != 0) {
+		while (left_count != 0) {
+			--left_count;
+			--right;
+			std::ranges::swap(*(left_base + bounded::integer(containers::data(left_offsets)[left_start + left_count])), *right);
+		}
+		left = right;
+	}
+	while (right_count != 0) {
+		--right_count;
+		std::ranges::swap(*(right_base - bounded::integer(containers::data(right_offsets)[right_start + right_count])), *left);
+		++left;
+	}
+	return left;
+}
+
+// Partitions around the pivot at `first`. Elements equal to the pivot go to
+// the right. Returns the final position of the pivot and whether no elements
+// had to be swapped.
+export template<typename Iterator>
+constexpr auto partition_right(Iterator const first, Iterator const last, auto const compare) -> partition_result<Iterator> {
+	auto pivot = std::move(*first);
+	auto left = first;
+	auto right = last;
+	do {
+		++left;
+	} while (compare(*left, pivot));
+	if (containers::prev(left) == first) {
+		while (left < right) {
+			--right;
+			if (compare(*right, pivot)) {
+				break;
+			}
+		}
+	} else {
+		do {
+			--right;
+		} while (!compare(*right, pivot));
+	}
+	auto const already_partitioned = !(left < right);
+	if constexpr (cheaply_sortable<std::remove_cvref_t<decltype(pivot)>>) {
+		if (!already_partitioned) {
+			std::ranges::swap(*left, *right);
+			++left;
+			left = ::containers::block_partition(left, right, pivot, compare);
+		}
+	} else {
+		while (left < right) {
+			std::ranges::swap(*left, *right);
+			do {
+				++left;
+			} while (compare(*left, pivot));
+			do {
+				--right;
+			} while (!compare(*right, pivot));
+		}
+	}
+	auto const pivot_position = containers::prev(left);
+	if (pivot_position != first) {
+		*first = std::move(*pivot_position);
+	}
+	*pivot_position = std::move(pivot);
+	return partition_result<Iterator>(pivot_position, already_partitioned);
+}
+
+// Partitions around the pivot at `first`. Elements equal to the pivot go to
+// the left. This is used when the element before the range is equal to the
+// pivot. Everything in the range is at least that element, so everything to
+// the left of the returned iterator is equal to the pivot and already sorted.
+export template<typename Iterator>
+constexpr auto partition_left(Iterator const first, Iterator const last, auto const compare) -> Iterator {
+	auto pivot = std::move(*first);
+	auto left = first;
+	auto right = last;
+	do {
+		--right;
+	} while (compare(pivot, *right));
+	if (containers::next(right) == last) {
+		while (left < right) {
+			++left;
+			if (compare(pivot, *left)) {
+				break;
+			}
+		}
+	} else {
+		do {
+			++left;
+		} while (!compare(pivot, *left));
+	}
+	while (left < right) {
+		std::ranges::swap(*left, *right);
+		do {
+			--right;
+		} while (compare(pivot, *right));
+		do {
+			++left;
+		} while (!compare(pivot, *left));
+	}
+	if (right != first) {
+		*first = std::move(*right);
+	}
+	*right = std::move(pivot);
+	return right;
+}
+
+// Swaps elements near the ends of a partition with elements a quarter of the
+// way in, so the next pivot comes from different elements
+export constexpr auto break_patterns(auto const first, auto const last) -> void {
+	auto const size = last - first;
+	if (size < insertion_sort_threshold) {
+		return;
+	}
+	auto const quarter = size / 4_bi;
+	std::ranges::swap(*first, *(first + quarter));
+	std::ranges::swap(*containers::prev(last), *(last - quarter));
+	if (size > ninther_threshold) {
+		std::ranges::swap(*(first + 1_bi), *(first + (quarter + 1_bi)));
+		std::ranges::swap(*(first + 2_bi), *(first + (quarter + 2_bi)));
+		std::ranges::swap(*(last - 2_bi), *(last - (quarter + 1_bi)));
+		std::ranges::swap(*(last - 3_bi), *(last - (quarter + 2_bi)));
+	}
+}
+
+} // namespace containers
@@ -0,0 +1,191 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.algorithms.sort.radix_select;
+
+import containers.algorithms.sort.nth_element;
+import containers.algorithms.sort.ska_sort;
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.advance;
+import containers.algorithms.compare;
+import containers.array;
+import containers.begin_end;
+import containers.data;
+import containers.extract_key_to_less;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.range_value_t;
+import containers.range_view;
+import containers.size;
+
+import bounded;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+// Below this size, another pass over the keys costs more than a comparison
+// based selection
+constexpr auto radix_select_threshold = 128_bi;
+
+template<typename Range, typename ExtractKey>
+concept radix_selectable = random_access_range<Range> and bounded::unsigned_builtin<std::decay_t<decltype(to_radix_sort_key(
+	bounded::declval<ExtractKey const &>()(bounded::declval<range_value_t<Range> const &>())
+))>>;
+
+// Selection by the most significant byte first. Each pass counts the bytes,
+// finds which byte value the element at `nth` has, and then partitions into
+// keys with a smaller byte, keys with that byte and keys with a larger byte.
+// Only the middle group is looked at again, one byte further along. Bytes that
+// are the same in every remaining key are skipped without moving anything.
+template<typename Iterator>
+constexpr auto radix_select_impl(Iterator first, Iterator last, Iterator const nth, auto const & extract_key) -> void {
+	using key_t = std::decay_t<decltype(to_radix_sort_key(extract_key(*first)))>;
+	auto byte_index = sizeof(key_t);
+	while (byte_index != 0) {
+		if (last - first <= radix_select_threshold) {
+			auto remaining = range_view(first, last);
+			::containers::nth_element(remaining, nth - first, extract_key_to_less(extract_key));
+			return;
+		}
+		--byte_index;
+		auto const shift = byte_index * 8U;
+		auto key_byte = [&](auto const & value) {
+			return static_cast<std::size_t>(static_cast<std::uint8_t>(to_radix_sort_key(extract_key(value)) >> shift));
+		};
+
+		auto counts = containers::array<std::size_t, 256_bi>();
+		for (auto it = first; it != last; ++it) {
+			++containers::data(counts)[key_byte(*it)];
+		}
+		auto const position = static_cast<std::size_t>(nth - first);
+		auto selected = std::size_t(0);
+		auto before = std::size_t(0);
+		while (before + containers::data(counts)[selected] <= position) {
+			before += containers::data(counts)[selected];
+			++selected;
+		}
+		if (containers::data(counts)[selected] == static_cast<std::size_t>(last - first)) {
+			continue;
+		}
+
+		auto low = first;
+		auto middle = first;
+		auto high = last;
+		while (middle != high) {
+			auto const byte = key_byte(*middle);
+			if (byte < selected) {
+				std::ranges::swap(*low, *middle);
+				++low;
+				++middle;
+			} else if (byte > selected) {
+				--high;
+				std::ranges::swap(*middle, *high);
+			} else {
+				++middle;
+			}
+		}
+		first = low;
+		last = high;
+	}
+}
+
+// Puts the element that would be at `index` after ska_sort at `index`, with no
+// element with a greater key before it and no element with a smaller key after
+// it. Keys that are not a single integer use nth_element.
+struct radix_select_t {
+	template<range Range, typename ExtractKey>
+	static constexpr auto operator()(Range && to_sort, auto const index, ExtractKey const & extract_key) -> void {
+		BOUNDED_ASSERT(index < containers::size(to_sort));
+		auto const first = containers::begin(to_sort);
+		auto const nth = first + ::bounded::assume_in_range<iter_difference_t<decltype(first)>>(index);
+		if constexpr (radix_selectable<Range, ExtractKey>) {
+			::containers::radix_select_impl(first, containers::end(to_sort), nth, extract_key);
+		} else {
+			::containers::nth_element(to_sort, index, extract_key_to_less(extract_key));
+		}
+	}
+	template<range Range>
+	static constexpr auto operator()(Range && to_sort, auto const index) -> void {
+		operator()(to_sort, index, to_radix_sort_key);
+	}
+};
+export constexpr auto radix_select = radix_select_t();
+
+// Sorts the `count` elements with the smallest keys into the front of the range,
+// as ska_sort would. The order of the rest is unspecified. This selects the
+// last of them first, so only the front of the range is ever sorted.
+struct partial_ska_sort_t {
+	template<range Range, typename ExtractKey>
+	static constexpr auto operator()(Range && to_sort, auto const count, ExtractKey const & extract_key) -> void {
+		BOUNDED_ASSERT(count <= containers::size(to_sort));
+		if (count == 0_bi) {
+			return;
+		}
+		auto const first = containers::begin(to_sort);
+		auto const last_sorted = containers::prev(first + ::bounded::assume_in_range<iter_difference_t<decltype(first)>>(count));
+		::containers::radix_select(to_sort, last_sorted - first, extract_key);
+		::containers::ska_sort(range_view(first, last_sorted), extract_key);
+	}
+	template<range Range>
+	static constexpr auto operator()(Range && to_sort, auto const count) -> void {
+		operator()(to_sort, count, to_radix_sort_key);
+	}
+};
+export constexpr auto partial_ska_sort = partial_ska_sort_t();
+
+} // namespace containers
+
+using namespace containers_test;
+
+constexpr auto test_partial_ska_sort(auto data, auto const count) -> bool {
+	containers::partial_ska_sort(data.input, count);
+	return containers::equal(
+		containers::begin(data.input),
+		containers::begin(data.input) + count,
+		containers::begin(data.expected)
+	);
+}
+
+static_assert(test_partial_ska_sort(uint8_many, 0_bi));
+static_assert(test_partial_ska_sort(uint8_many, 1_bi));
+static_assert(test_partial_ska_sort(uint8_many, 10_bi));
+static_assert(test_partial_ska_sort(uint16_many, 7_bi));
+static_assert(test_partial_ska_sort(uint32_many, 15_bi));
+static_assert(test_partial_ska_sort(uint64_many, 20_bi));
+static_assert(test_partial_ska_sort(tuple_many, 5_bi));
+
+static_assert([] {
+	auto values = containers::array<std::uint32_t, 1000_bi>();
+	auto value = std::uint32_t(1);
+	for (auto & element : values) {
+		// A few large values that all share their high bytes, and many small
+		// values, so several passes are needed
+		value = value * 1'103'515'245U + 12'345U;
+		element = value % 4 == 0 ? 0x1234'0000U | (value >> 16U) : value % 300U;
+	}
+	auto expected = values;
+	containers::ska_sort(expected);
+	for (auto const index : containers::array{0, 1, 499, 700, 800, 999}) {
+		auto input = values;
+		containers::radix_select(input, index);
+		auto const nth = containers::begin(input) + bounded::assume_in_range<containers::iter_difference_t<decltype(containers::begin(input))>>(index);
+		BOUNDED_ASSERT(*nth == *(containers::begin(expected) + (nth - containers::begin(input))));
+		for (auto it = containers::begin(input); it != nth; ++it) {
+			BOUNDED_ASSERT(*it <= *nth);
+		}
+		for (auto it = nth; it != containers::end(input); ++it) {
+			BOUNDED_ASSERT(*nth <= *it);
+		}
+	}
+	return true;
+}());
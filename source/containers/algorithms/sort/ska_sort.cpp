@@ -10,7 +10,11 @@
 
 export module containers.algorithms.sort.ska_sort;
 
+import containers.algorithms.sort.counting_sort;
 import containers.algorithms.sort.inplace_radix_sort;
+import containers.algorithms.sort.key_cached_sort;
+import containers.algorithms.sort.sort_tuning;
+import containers.algorithms.sort.string_sort;
 import containers.algorithms.sort.to_radix_sort_key;
 
 import containers.algorithms.erase;
@@ -19,18 +23,38 @@ import containers.algorithms.unique;
 import containers.begin_end;
 import containers.is_range;
 import containers.range_view;
+import containers.size;
+
+import std_module;
 
 namespace containers {
 
 struct ska_sort_t {
-	static constexpr void operator()(range auto && to_sort, auto const & extract_key) {
-		::containers::inplace_radix_sort<128, 1024>(
-			range_view(
-				containers::begin(to_sort),
-				containers::end(to_sort)
-			),
-			extract_key
+	static constexpr void operator()(range auto && to_sort, auto const & extract_key, sort_tuning const tuning) {
+		auto const view = range_view(
+			containers::begin(to_sort),
+			containers::end(to_sort)
 		);
+		if constexpr (counting_sortable<decltype(view), std::decay_t<decltype(extract_key)>>) {
+			if (::containers::prefer_counting_sort(view, extract_key)) {
+				::containers::counting_sort(view, extract_key);
+				return;
+			}
+		}
+		if constexpr (string_sortable<decltype(view), std::decay_t<decltype(extract_key)>>) {
+			::containers::string_sort(view, extract_key);
+			return;
+		}
+		if constexpr (prefer_key_cached_sort<decltype(view), std::decay_t<decltype(extract_key)>>) {
+			if (containers::size(view) >= key_cached_sort_minimum_size) {
+				::containers::key_cached_sort(view, extract_key);
+				return;
+			}
+		}
+		::containers::inplace_radix_sort(view, extract_key, tuning);
+	}
+	static constexpr void operator()(range auto && to_sort, auto const & extract_key) {
+		operator()(to_sort, extract_key, default_sort_tuning());
 	}
 	static constexpr void operator()(range auto && to_sort) {
 		operator()(to_sort, to_radix_sort_key);
@@ -16,9 +16,11 @@ import containers.algorithms.sort.sort_exactly_3;
 import containers.algorithms.sort.sort_exactly_4;
 import containers.algorithms.sort.sort_exactly_5;
 import containers.algorithms.sort.sort_exactly_6;
+import containers.algorithms.sort.sorting_network;
 
 import containers.begin_end;
 import containers.is_range;
+import containers.range_value_t;
 import containers.size;
 
 import bounded;
@@ -63,6 +65,12 @@ inline constexpr auto small_size_optimized_sort(Range && r, auto const compare,
 			return;
 		default:
 			if constexpr (max_size >= max_small_sort_size) {
+				if constexpr (network_sortable<Range, std::remove_const_t<decltype(compare)>> and prefer_network_sort<range_value_t<Range>>) {
+					if (containers::size(r) <= max_network_sort_size) {
+						::containers::network_sort(r);
+						return;
+					}
+				}
 				sort_large_range(r, compare);
 				return;
 			} else {
@@ -10,14 +10,13 @@ module;
 export module containers.algorithms.sort.sort;
 
 import containers.algorithms.sort.is_sorted;
+import containers.algorithms.sort.quicksort_partition;
 import containers.algorithms.sort.small_size_optimized_sort;
-import containers.algorithms.sort.sort_exactly_3;
-import containers.algorithms.sort.sort_exactly_5;
 import containers.algorithms.sort.sort_test_data;
 import containers.algorithms.sort.test_sort_inplace_and_relocate;
 
 import containers.algorithms.advance;
-import containers.algorithms.partition;
+import containers.algorithms.parallel_for_each_index;
 
 import containers.array;
 import containers.begin_end;
@@ -41,50 +40,188 @@ constexpr auto heap_sort(range auto && r, auto const compare) -> void {
 	std::sort_heap(make_legacy_iterator(first), make_legacy_iterator(last), compare);
 }
 
-constexpr auto introsort(range auto && r, auto const compare, auto depth) -> void;
+// This is pattern-defeating quicksort, as described in
+// https://arxiv.org/abs/2106.05123. It is introsort with a few changes that
+// make common input patterns cheap:
+// * Partitions that were already partitioned are finished with an insertion
+//   sort that gives up after a few moves, so sorted and almost sorted inputs
+//   are linear.
+// * When the pivot is equal to the element just before the range, every element
+//   equal to the pivot is put in its final position at once, so inputs with few
+//   distinct values are linear in the number of elements.
+// * Badly unbalanced partitions swap a few elements around to break up the
+//   pattern that caused them, and fall back to heap sort only after
+//   log2(size) of them.
 
+constexpr auto partial_insertion_sort_limit = 8_bi;
+
+// Returns false, leaving the range partially sorted, if it would need to move
+// elements more than `limit` positions in total.
+constexpr auto insertion_sort_with_limit(auto const first, auto const last, auto const compare, std::size_t const limit) -> bool {
+	if (first == last) {
+		return true;
+	}
+	auto moves = std::size_t(0);
+	for (auto it = containers::next(first); it != last; ++it) {
+		auto previous = containers::prev(it);
+		if (!compare(*it, *previous)) {
+			continue;
+		}
+		auto temp = std::move(*it);
+		auto hole = it;
+		do {
+			*hole = std::move(*previous);
+			hole = previous;
+		} while (hole != first and compare(temp, *(previous = containers::prev(hole))));
+		*hole = std::move(temp);
+		moves += static_cast<std::size_t>(it - hole);
+		if (moves > limit) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// `leftmost` is false when the element before `first` is part of the original
+// range, which means it is not greater than anything in [first, last).
+template<bounded::bounded_integer Depth>
+constexpr auto pattern_defeating_sort(auto first, auto const last, auto const compare, Depth bad_partitions_allowed, bool leftmost) -> void {
+	while (true) {
+		auto const size = last - first;
+		if (size < insertion_sort_threshold) {
+			::containers::small_size_optimized_sort(
+				range_view(first, last),
+				compare,
+				[](auto && r, auto const cmp) {
+					::containers::insertion_sort_with_limit(containers::begin(r), containers::end(r), cmp, numeric_traits::max_value<std::size_t>);
+				}
+			);
+			return;
+		}
+		::containers::choose_pivot(first, last, size, compare);
+		if (!leftmost and !compare(*containers::prev(first), *first)) {
+			first = containers::next(::containers::partition_left(first, last, compare));
+			continue;
+		}
+		auto const partitioned = ::containers::partition_right(first, last, compare);
+		auto const pivot = partitioned.pivot;
+		auto const left_size = pivot - first;
+		auto const right_size = last - containers::next(pivot);
+		if (left_size < size / 8_bi or right_size < size / 8_bi) {
+			bad_partitions_allowed = ::bounded::assume_in_range<Depth>(bad_partitions_allowed - 1_bi);
+			if (bad_partitions_allowed == 0_bi) {
+				::containers::heap_sort(range_view(first, last), compare);
+				return;
+			}
+			::containers::break_patterns(first, pivot);
+			::containers::break_patterns(containers::next(pivot), last);
+		} else if (
+			partitioned.already_partitioned and
+			::containers::insertion_sort_with_limit(first, pivot, compare, partial_insertion_sort_limit) and
+			::containers::insertion_sort_with_limit(containers::next(pivot), last, compare, partial_insertion_sort_limit)
+		) {
+			return;
+		}
+		::containers::pattern_defeating_sort(first, pivot, compare, bad_partitions_allowed, leftmost);
+		first = containers::next(pivot);
+		leftmost = false;
+	}
+}
+
+// Below this size, sorting a partition in the current thread is faster than
+// handing it to another thread
+constexpr auto parallel_sort_minimum_size = 16'384_bi;
+
+// This is the same loop as `pattern_defeating_sort`, with the same checks for
+// bad partitions and already sorted input. When both sides of a partition are
+// large enough, each is given half of the remaining threads, and the thread
+// that partitioned sorts the second half itself, so a range that is split n
+// times uses at most 2^n threads. Otherwise the smaller side is sorted in this
+// thread and the larger side keeps all of the threads.
 template<bounded::bounded_integer Depth>
-constexpr auto introsort_impl(Depth const depth) {
-	return [=](range auto && r, auto const compare) {
-		if (depth == 0_bi) {
-			::containers::heap_sort(r, compare);
+auto parallel_pattern_defeating_sort(auto first, auto last, auto const compare, Depth bad_partitions_allowed, bool leftmost, std::size_t const threads) -> void {
+	while (true) {
+		auto const size = last - first;
+		if (threads <= 1 or size < parallel_sort_minimum_size) {
+			::containers::pattern_defeating_sort(first, last, compare, bad_partitions_allowed, leftmost);
 			return;
 		}
-		auto const length = containers::size(r);
-		auto const first = containers::begin(r);
-		auto const last = containers::end(r);
-		auto median = first + length / 2_bi;
-		auto const before_last = containers::prev(last);
-		auto median_of = [&](auto... its) {
-			::containers::sort_exactly_n_impl(*its..., compare);
-		};
-		if (length >= 1000_bi) {
-			median_of(first, first + length / 4_bi, median, median + length / 4_bi, before_last);
-		} else {
-			static_assert(max_small_sort_size >= 3_bi);
-			median_of(first, median, before_last);
+		::containers::choose_pivot(first, last, size, compare);
+		if (!leftmost and !compare(*containers::prev(first), *first)) {
+			first = containers::next(::containers::partition_left(first, last, compare));
+			continue;
 		}
-		median = iterator_partition(first, median, last, compare);
-		auto next_depth = Depth(bounded::assume_in_range<Depth>(depth - 1_bi));
-		::containers::introsort(range_view(first, median), compare, next_depth);
-		::containers::introsort(range_view(median, last), compare, next_depth);
-	};
+		auto const partitioned = ::containers::partition_right(first, last, compare);
+		auto const pivot = partitioned.pivot;
+		auto const left_size = pivot - first;
+		auto const right_size = last - containers::next(pivot);
+		if (left_size < size / 8_bi or right_size < size / 8_bi) {
+			bad_partitions_allowed = ::bounded::assume_in_range<Depth>(bad_partitions_allowed - 1_bi);
+			if (bad_partitions_allowed == 0_bi) {
+				::containers::heap_sort(range_view(first, last), compare);
+				return;
+			}
+			::containers::break_patterns(first, pivot);
+			::containers::break_patterns(containers::next(pivot), last);
+		} else if (
+			partitioned.already_partitioned and
+			::containers::insertion_sort_with_limit(first, pivot, compare, partial_insertion_sort_limit) and
+			::containers::insertion_sort_with_limit(containers::next(pivot), last, compare, partial_insertion_sort_limit)
+		) {
+			return;
+		}
+		if (left_size < parallel_sort_minimum_size) {
+			::containers::pattern_defeating_sort(first, pivot, compare, bad_partitions_allowed, leftmost);
+			first = containers::next(pivot);
+			leftmost = false;
+			continue;
+		}
+		if (right_size < parallel_sort_minimum_size) {
+			::containers::pattern_defeating_sort(containers::next(pivot), last, compare, bad_partitions_allowed, false);
+			last = pivot;
+			continue;
+		}
+		auto const first_threads = threads / 2;
+		auto first_half = std::async(std::launch::async, [&] {
+			::containers::parallel_pattern_defeating_sort(first, pivot, compare, bad_partitions_allowed, leftmost, first_threads);
+		});
+		::containers::parallel_pattern_defeating_sort(containers::next(pivot), last, compare, bad_partitions_allowed, false, threads - first_threads);
+		first_half.get();
+		return;
+	}
 }
 
-inline constexpr auto introsort(range auto && r, auto const compare, auto depth) -> void {
-	::containers::small_size_optimized_sort(r, compare, introsort_impl(depth));
+constexpr auto bad_partition_limit(range auto const & to_sort) {
+	auto const size = bounded::integer(containers::size(to_sort));
+	auto const allowed = bounded::log(size, 2_bi);
+	return bounded::integer<0, bounded::builtin_max_value<decltype(allowed)>>(allowed);
 }
 
 struct new_sort_t {
 	template<range Range>
 	constexpr auto operator()(Range & to_sort, auto compare) const -> void {
 		if constexpr (numeric_traits::max_value<range_size_t<Range>> >= 2_bi) {
-			auto const size = bounded::integer(containers::size(to_sort));
-			auto const depth = 2_bi * bounded::log(size, 2_bi);
-			introsort(
-				to_sort,
+			::containers::pattern_defeating_sort(
+				containers::begin(to_sort),
+				containers::end(to_sort),
 				compare,
-				bounded::integer<0, bounded::builtin_max_value<decltype(depth)>>(depth)
+				::containers::bad_partition_limit(to_sort),
+				true
+			);
+		}
+		BOUNDED_ASSERT(is_sorted(to_sort, compare));
+	}
+	// `compare` may be called from several threads at once
+	template<range Range>
+	auto operator()(Range & to_sort, auto compare, thread_count_t const threads) const -> void {
+		if constexpr (numeric_traits::max_value<range_size_t<Range>> >= 2_bi) {
+			::containers::parallel_pattern_defeating_sort(
+				containers::begin(to_sort),
+				containers::end(to_sort),
+				compare,
+				::containers::bad_partition_limit(to_sort),
+				true,
+				static_cast<std::size_t>(threads)
 			);
 		}
 		BOUNDED_ASSERT(is_sorted(to_sort, compare));
@@ -117,6 +254,11 @@ static_assert(test_sort(uint8_1, containers::sort));
 static_assert(test_sort(uint8_2, containers::sort));
 static_assert(test_sort(uint8_3, containers::sort));
 
+static_assert(test_sort(uint8_1, containers::new_sort));
+static_assert(test_sort(uint8_2, containers::new_sort));
+static_assert(test_sort(uint8_3, containers::new_sort));
+static_assert(test_sort(int_patterns, containers::new_sort));
+
 static_assert(test_sort(
 	containers::array{
 		sort_test_data(
@@ -0,0 +1,190 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.algorithms.sort.sort_permutation;
+
+import containers.algorithms.sort.inplace_radix_sort;
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.sort_tuning;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.compare;
+import containers.array;
+import containers.begin_end;
+import containers.data;
+import containers.index_type;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.push_back;
+import containers.range_value_t;
+import containers.range_view;
+import containers.repeat_n;
+import containers.size;
+import containers.vector;
+
+import bounded;
+import std_module;
+import tv;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+export template<typename Range, typename ExtractKey>
+using extracted_key_t = std::invoke_result_t<ExtractKey const &, range_value_t<Range> const &>;
+
+// The key must be a value, not a reference into the element, and it has to be
+// small enough that a key and an index are cheaper to move around than the
+// element itself.
+export template<typename Range, typename ExtractKey>
+concept key_cacheable =
+	random_access_range<Range> and
+	!std::is_reference_v<extracted_key_t<Range, ExtractKey>> and
+	std::is_trivially_copyable_v<extracted_key_t<Range, ExtractKey>> and
+	sizeof(extracted_key_t<Range, ExtractKey>) <= 16;
+
+template<typename Key, typename Index>
+struct cached_key {
+	Key key;
+	Index index;
+};
+
+struct get_cached_key {
+	static constexpr auto operator()(auto const & value) -> auto const & {
+		return value.key;
+	}
+};
+
+constexpr auto at_position(auto const first, std::size_t const position) -> decltype(auto) {
+	return *(first + ::bounded::assume_in_range<iter_difference_t<decltype(first)>>(position));
+}
+
+// Reorders `to_permute` so that the element at position n is the one that was
+// at `permutation[n]`. Each cycle of the permutation is followed once, so every
+// element is relocated exactly once no matter how large it is. `permutation`
+// is not modified, so it can be applied to several ranges.
+struct apply_permutation_inplace_t {
+	template<random_access_range Range, random_access_range Permutation>
+	static constexpr auto operator()(Range && to_permute, Permutation const & permutation) -> void {
+		BOUNDED_ASSERT(containers::size(to_permute) == containers::size(permutation));
+		auto const first = containers::begin(to_permute);
+		auto const indexes = containers::begin(permutation);
+		auto const size = static_cast<std::size_t>(containers::size(to_permute));
+		auto done = containers::vector<bool>(containers::repeat_n(
+			::bounded::assume_in_range<range_size_t<containers::vector<bool>>>(size),
+			false
+		));
+		auto const is_done = containers::data(done);
+		for (auto start = std::size_t(0); start != size; ++start) {
+			auto source = static_cast<std::size_t>(::containers::at_position(indexes, start));
+			if (is_done[start] or source == start) {
+				continue;
+			}
+			auto temp = ::tv::relocate_into_storage(::containers::at_position(first, start));
+			auto destination = start;
+			while (true) {
+				is_done[destination] = true;
+				if (source == start) {
+					::bounded::relocate_at(::containers::at_position(first, destination), temp.value);
+					break;
+				}
+				::bounded::relocate_at(::containers::at_position(first, destination), ::containers::at_position(first, source));
+				destination = source;
+				source = static_cast<std::size_t>(::containers::at_position(indexes, destination));
+			}
+		}
+	}
+};
+export constexpr auto apply_permutation_inplace = apply_permutation_inplace_t();
+
+// Returns the indexes of the elements of `to_sort` in the order ska_sort would
+// put them, without moving any elements. Small keys are extracted once and
+// radix sorted together with their index. Anything else is looked up through
+// the index on every pass.
+struct sort_permutation_t {
+	template<random_access_range Range, typename ExtractKey>
+	static constexpr auto operator()(Range const & to_sort, ExtractKey const & extract_key) -> containers::vector<index_type<Range>> {
+		using index_t = index_type<Range>;
+		using result_t = containers::vector<index_t>;
+		auto const size = containers::size(to_sort);
+		auto result = result_t();
+		result.reserve(::bounded::assume_in_range<range_size_t<result_t>>(size));
+		auto const first = containers::begin(to_sort);
+		if constexpr (key_cacheable<Range, ExtractKey>) {
+			using element_t = cached_key<extracted_key_t<Range, ExtractKey>, index_t>;
+			using keys_t = containers::vector<element_t>;
+			auto keys = keys_t();
+			keys.reserve(::bounded::assume_in_range<range_size_t<keys_t>>(size));
+			auto index = std::size_t(0);
+			for (auto const & value : to_sort) {
+				::containers::push_back(keys, element_t(extract_key(value), ::bounded::assume_in_range<index_t>(index)));
+				++index;
+			}
+			::containers::inplace_radix_sort(
+				range_view(containers::begin(keys), containers::end(keys)),
+				get_cached_key(),
+				default_sort_tuning()
+			);
+			for (auto const & key : keys) {
+				::containers::push_back(result, key.index);
+			}
+		} else {
+			for (auto index = std::size_t(0); index != static_cast<std::size_t>(size); ++index) {
+				::containers::push_back(result, ::bounded::assume_in_range<index_t>(index));
+			}
+			::containers::inplace_radix_sort(
+				range_view(containers::begin(result), containers::end(result)),
+				[&](index_t const index) -> decltype(auto) {
+					return extract_key(::containers::at_position(first, static_cast<std::size_t>(index)));
+				},
+				default_sort_tuning()
+			);
+		}
+		return result;
+	}
+	template<random_access_range Range>
+	static constexpr auto operator()(Range const & to_sort) -> containers::vector<index_type<Range>> {
+		return operator()(to_sort, to_radix_sort_key);
+	}
+};
+export constexpr auto sort_permutation = sort_permutation_t();
+
+} // namespace containers
+
+using namespace containers_test;
+
+static_assert([] {
+	auto const keys = containers::array{30, 10, 20, 0};
+	auto const permutation = containers::sort_permutation(keys);
+	BOUNDED_ASSERT(containers::equal(
+		containers::begin(permutation),
+		containers::end(permutation),
+		containers::begin(containers::array{3, 1, 2, 0})
+	));
+	auto names = containers::array{'c', 'a', 'b', 'z'};
+	auto values = keys;
+	containers::apply_permutation_inplace(names, permutation);
+	containers::apply_permutation_inplace(values, permutation);
+	return
+		names == containers::array{'z', 'a', 'b', 'c'} and
+		values == containers::array{0, 10, 20, 30};
+}());
+
+constexpr auto test_sort_by_permutation(auto data, auto const & extract_key) -> bool {
+	auto const permutation = containers::sort_permutation(data.input, extract_key);
+	containers::apply_permutation_inplace(data.input, permutation);
+	return data.input == data.expected;
+}
+
+static_assert(test_sort_by_permutation(uint8_many, containers::to_radix_sort_key));
+static_assert(test_sort_by_permutation(uint32_many, default_copy));
+static_assert(test_sort_by_permutation(uint64_many, containers::to_radix_sort_key));
+static_assert(test_sort_by_permutation(tuple_many, containers::to_radix_sort_key));
+static_assert(test_sort_by_permutation(strings, std::identity()));
+static_assert(test_sort_by_permutation(make_move_only(), default_copy));
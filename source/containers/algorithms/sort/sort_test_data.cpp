@@ -19,7 +19,9 @@ import containers.algorithms.sort.to_radix_sort_key;
 
 import containers.array;
 import containers.c_array;
+import containers.data;
 import containers.front_back;
+import containers.integer_range;
 import containers.static_vector;
 import containers.vector;
 
@@ -854,4 +856,39 @@ export constexpr auto make_wrapper() {
 	);
 }
 
+// Inputs that a quicksort has to recognize to avoid doing more work than
+// necessary. They are larger than any small-size special case.
+constexpr auto pattern_size = 200_bi;
+
+constexpr auto make_pattern(auto const function) {
+	auto input = containers::array<int, pattern_size>();
+	for (auto const n : containers::integer_range(pattern_size)) {
+		input[n] = function(static_cast<int>(n));
+	}
+	auto expected = input;
+	std::sort(containers::data(expected), containers::data(expected) + static_cast<std::ptrdiff_t>(pattern_size));
+	return sort_test_data(input, expected);
+}
+
+export constexpr auto int_patterns = containers::array{
+	// sorted
+	make_pattern([](int const n) { return n; }),
+	// reverse sorted
+	make_pattern([](int const n) { return 200 - n; }),
+	// all equal
+	make_pattern([](int) { return 5; }),
+	// few unique
+	make_pattern([](int const n) { return (n * 7) % 3; }),
+	// organ pipe
+	make_pattern([](int const n) { return n < 100 ? n : 200 - n; }),
+	// sawtooth
+	make_pattern([](int const n) { return n % 16; }),
+	// sorted, with the smallest element moved to the end
+	make_pattern([](int const n) { return (n + 1) % 200; }),
+	// sorted, with a few elements out of place
+	make_pattern([](int const n) { return n % 50 == 0 ? 200 - n : n; }),
+	// shuffled
+	make_pattern([](int const n) { return (n * 7919) % 211; }),
+};
+
 } // namespace containers_test
\ No newline at end of file
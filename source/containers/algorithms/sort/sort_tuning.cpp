@@ -0,0 +1,52 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+export module containers.algorithms.sort.sort_tuning;
+
+import std_module;
+
+namespace containers {
+
+// The sizes at which the radix sort switches strategies for a bucket. The best
+// values depend on the size of the elements and on the cache sizes of the
+// machine, so they can be measured with sort_tuning_calibration.
+export struct sort_tuning {
+	// Buckets with at most this many elements use a comparison sort
+	std::ptrdiff_t std_sort_threshold = 128;
+	// Buckets with fewer elements than this, and more than
+	// `std_sort_threshold`, use american flag sort. Larger buckets use the
+	// ska_sort byte partition, which does fewer swaps but more passes.
+	std::ptrdiff_t american_flag_sort_threshold = 1024;
+
+	friend auto operator==(sort_tuning, sort_tuning) -> bool = default;
+};
+
+// Each threshold is read and written on its own. Setting a new default while
+// another thread is sorting can give that sort one old and one new threshold,
+// which is a valid tuning.
+constinit auto global_std_sort_threshold = std::atomic<std::ptrdiff_t>(sort_tuning().std_sort_threshold);
+constinit auto global_american_flag_sort_threshold = std::atomic<std::ptrdiff_t>(sort_tuning().american_flag_sort_threshold);
+
+// The tuning used by sorts that are not given one. This is always the built-in
+// tuning during constant evaluation.
+export constexpr auto default_sort_tuning() -> sort_tuning {
+	if consteval {
+		return sort_tuning();
+	} else {
+		return sort_tuning(
+			global_std_sort_threshold.load(std::memory_order_relaxed),
+			global_american_flag_sort_threshold.load(std::memory_order_relaxed)
+		);
+	}
+}
+
+export auto set_default_sort_tuning(sort_tuning const tuning) -> void {
+	global_std_sort_threshold.store(tuning.std_sort_threshold, std::memory_order_relaxed);
+	global_american_flag_sort_threshold.store(tuning.american_flag_sort_threshold, std::memory_order_relaxed);
+}
+
+} // namespace containers
+
+static_assert(containers::default_sort_tuning() == containers::sort_tuning());
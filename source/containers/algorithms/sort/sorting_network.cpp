@@ -0,0 +1,394 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+#if defined(__AVX2__) or defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+export module containers.algorithms.sort.sorting_network;
+
+import containers.algorithms.sort.is_sorted;
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.test_sort_inplace_and_relocate;
+
+import containers.array;
+import containers.data;
+import containers.is_range;
+import containers.range_value_t;
+import containers.size;
+
+import bounded;
+import numeric_traits;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+// Bitonic sorting networks for arithmetic types. The input is padded with the
+// largest value of the type up to 8, 16, or 32 elements so that every network
+// is a whole number of vector registers. With AVX2 or SSE4.1, 32-bit integers
+// and floats are sorted entirely in registers. Everything else uses the same
+// network on scalars.
+//
+// NaN is not supported.
+
+export constexpr auto max_network_sort_size = 32_bi;
+
+export template<typename Range, typename Compare>
+concept network_sortable =
+	contiguous_range<Range> and
+	std::is_arithmetic_v<range_value_t<Range>> and
+	!std::same_as<range_value_t<Range>, bool> and
+	(std::same_as<Compare, std::less<>> or std::same_as<Compare, std::less<range_value_t<Range>>>);
+
+template<typename T>
+constexpr auto network_padding_value() -> T {
+	if constexpr (std::floating_point<T>) {
+		return std::numeric_limits<T>::infinity();
+	} else {
+		return numeric_traits::max_value<T>;
+	}
+}
+
+// Whether the element at `index` ends up with the larger value of its pair
+constexpr auto takes_max(std::size_t const index, std::size_t const block, std::size_t const stride) -> bool {
+	return ((index & stride) != 0) != ((index & block) != 0);
+}
+
+template<typename T, std::size_t size>
+constexpr auto scalar_bitonic_sort(std::array<T, size> & values) -> void {
+	for (std::size_t block = 2; block <= size; block *= 2) {
+		for (std::size_t stride = block / 2; stride != 0; stride /= 2) {
+			for (std::size_t index = 0; index != size; ++index) {
+				auto const partner = index ^ stride;
+				if (partner > index) {
+					auto const low = std::min(values[index], values[partner]);
+					auto const high = std::max(values[index], values[partner]);
+					auto const ascending = (index & block) == 0;
+					values[index] = ascending ? low : high;
+					values[partner] = ascending ? high : low;
+				}
+			}
+		}
+	}
+}
+
+#if defined(__AVX2__) or defined(__SSE4_1__)
+
+template<typename T>
+struct simd_network;
+
+// Which lanes of each register take the max in a given step
+template<std::size_t lanes, std::size_t block, std::size_t stride>
+constexpr auto network_masks = [] {
+	auto result = std::array<std::array<std::int32_t, lanes>, static_cast<std::size_t>(max_network_sort_size) / lanes>();
+	for (std::size_t r = 0; r != result.size(); ++r) {
+		for (std::size_t lane = 0; lane != lanes; ++lane) {
+			result[r][lane] = takes_max(r * lanes + lane, block, stride) ? -1 : 0;
+		}
+	}
+	return result;
+}();
+
+#if defined(__AVX2__)
+
+template<std::size_t stride>
+constexpr auto network_partners = [] {
+	auto result = std::array<std::int32_t, 8>();
+	for (std::size_t lane = 0; lane != result.size(); ++lane) {
+		result[lane] = static_cast<std::int32_t>(lane ^ stride);
+	}
+	return result;
+}();
+
+inline auto load_indexes(std::array<std::int32_t, 8> const & indexes) -> __m256i {
+	return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(indexes.data()));
+}
+
+template<typename T> requires(std::same_as<T, std::int32_t> or std::same_as<T, std::uint32_t>)
+struct simd_network<T> {
+	static constexpr auto lanes = std::size_t(8);
+	using vector = __m256i;
+	static auto load(T const * const ptr) -> vector {
+		return _mm256_loadu_si256(reinterpret_cast<vector const *>(ptr));
+	}
+	static auto store(T * const ptr, vector const value) -> void {
+		_mm256_storeu_si256(reinterpret_cast<vector *>(ptr), value);
+	}
+	static auto min(vector const lhs, vector const rhs) -> vector {
+		if constexpr (std::is_signed_v<T>) {
+			return _mm256_min_epi32(lhs, rhs);
+		} else {
+			return _mm256_min_epu32(lhs, rhs);
+		}
+	}
+	static auto max(vector const lhs, vector const rhs) -> vector {
+		if constexpr (std::is_signed_v<T>) {
+			return _mm256_max_epi32(lhs, rhs);
+		} else {
+			return _mm256_max_epu32(lhs, rhs);
+		}
+	}
+	template<std::size_t stride>
+	static auto swap_pairs(vector const value) -> vector {
+		return _mm256_permutevar8x32_epi32(value, load_indexes(network_partners<stride>));
+	}
+	template<std::size_t block, std::size_t stride>
+	static auto blend(vector const low, vector const high, std::size_t const r) -> vector {
+		return _mm256_blendv_epi8(low, high, load_indexes(network_masks<lanes, block, stride>[r]));
+	}
+};
+
+template<>
+struct simd_network<float> {
+	static constexpr auto lanes = std::size_t(8);
+	using vector = __m256;
+	static auto load(float const * const ptr) -> vector {
+		return _mm256_loadu_ps(ptr);
+	}
+	static auto store(float * const ptr, vector const value) -> void {
+		_mm256_storeu_ps(ptr, value);
+	}
+	static auto min(vector const lhs, vector const rhs) -> vector {
+		return _mm256_min_ps(lhs, rhs);
+	}
+	static auto max(vector const lhs, vector const rhs) -> vector {
+		return _mm256_max_ps(lhs, rhs);
+	}
+	template<std::size_t stride>
+	static auto swap_pairs(vector const value) -> vector {
+		return _mm256_permutevar8x32_ps(value, load_indexes(network_partners<stride>));
+	}
+	template<std::size_t block, std::size_t stride>
+	static auto blend(vector const low, vector const high, std::size_t const r) -> vector {
+		return _mm256_blendv_ps(low, high, _mm256_castsi256_ps(load_indexes(network_masks<lanes, block, stride>[r])));
+	}
+};
+
+#else
+
+// Immediate for _mm_shuffle that swaps each lane with lane ^ stride
+template<std::size_t stride>
+constexpr auto sse_swap_pairs = stride == 1 ? 0b10'11'00'01 : 0b01'00'11'10;
+
+inline auto load_mask(std::array<std::int32_t, 4> const & mask) -> __m128i {
+	return _mm_loadu_si128(reinterpret_cast<__m128i const *>(mask.data()));
+}
+
+template<typename T> requires(std::same_as<T, std::int32_t> or std::same_as<T, std::uint32_t>)
+struct simd_network<T> {
+	static constexpr auto lanes = std::size_t(4);
+	using vector = __m128i;
+	static auto load(T const * const ptr) -> vector {
+		return _mm_loadu_si128(reinterpret_cast<vector const *>(ptr));
+	}
+	static auto store(T * const ptr, vector const value) -> void {
+		_mm_storeu_si128(reinterpret_cast<vector *>(ptr), value);
+	}
+	static auto min(vector const lhs, vector const rhs) -> vector {
+		if constexpr (std::is_signed_v<T>) {
+			return _mm_min_epi32(lhs, rhs);
+		} else {
+			return _mm_min_epu32(lhs, rhs);
+		}
+	}
+	static auto max(vector const lhs, vector const rhs) -> vector {
+		if constexpr (std::is_signed_v<T>) {
+			return _mm_max_epi32(lhs, rhs);
+		} else {
+			return _mm_max_epu32(lhs, rhs);
+		}
+	}
+	template<std::size_t stride>
+	static auto swap_pairs(vector const value) -> vector {
+		return _mm_shuffle_epi32(value, sse_swap_pairs<stride>);
+	}
+	template<std::size_t block, std::size_t stride>
+	static auto blend(vector const low, vector const high, std::size_t const r) -> vector {
+		return _mm_blendv_epi8(low, high, load_mask(network_masks<lanes, block, stride>[r]));
+	}
+};
+
+template<>
+struct simd_network<float> {
+	static constexpr auto lanes = std::size_t(4);
+	using vector = __m128;
+	static auto load(float const * const ptr) -> vector {
+		return _mm_loadu_ps(ptr);
+	}
+	static auto store(float * const ptr, vector const value) -> void {
+		_mm_storeu_ps(ptr, value);
+	}
+	static auto min(vector const lhs, vector const rhs) -> vector {
+		return _mm_min_ps(lhs, rhs);
+	}
+	static auto max(vector const lhs, vector const rhs) -> vector {
+		return _mm_max_ps(lhs, rhs);
+	}
+	template<std::size_t stride>
+	static auto swap_pairs(vector const value) -> vector {
+		return _mm_shuffle_ps(value, value, sse_swap_pairs<stride>);
+	}
+	template<std::size_t block, std::size_t stride>
+	static auto blend(vector const low, vector const high, std::size_t const r) -> vector {
+		return _mm_blendv_ps(low, high, _mm_castsi128_ps(load_mask(network_masks<lanes, block, stride>[r])));
+	}
+};
+#endif
+
+template<typename T>
+concept has_simd_network = requires { simd_network<T>::lanes; };
+
+// Pairs that are at least a register apart are a min and max of whole
+// registers. Pairs within a register compare against a shuffled copy of the
+// register and then pick the min or max for each lane.
+template<typename T, std::size_t size, std::size_t block, std::size_t stride>
+auto simd_bitonic_step(typename simd_network<T>::vector * const registers) -> void {
+	using network = simd_network<T>;
+	constexpr auto lanes = network::lanes;
+	constexpr auto register_count = size / lanes;
+	if constexpr (stride >= lanes) {
+		constexpr auto register_stride = stride / lanes;
+		for (std::size_t r = 0; r != register_count; ++r) {
+			if ((r & register_stride) == 0) {
+				auto & first = registers[r];
+				auto & second = registers[r | register_stride];
+				auto const low = network::min(first, second);
+				auto const high = network::max(first, second);
+				auto const ascending = ((r * lanes) & block) == 0;
+				first = ascending ? low : high;
+				second = ascending ? high : low;
+			}
+		}
+	} else {
+		for (std::size_t r = 0; r != register_count; ++r) {
+			auto & value = registers[r];
+			auto const partner = network::template swap_pairs<stride>(value);
+			value = network::template blend<block, stride>(
+				network::min(value, partner),
+				network::max(value, partner),
+				r
+			);
+		}
+	}
+	if constexpr (stride != 1) {
+		::containers::simd_bitonic_step<T, size, block, stride / 2>(registers);
+	} else if constexpr (block != size) {
+		::containers::simd_bitonic_step<T, size, block * 2, block>(registers);
+	}
+}
+
+template<typename T, std::size_t size>
+auto simd_bitonic_sort(std::array<T, size> & values) -> void {
+	using network = simd_network<T>;
+	constexpr auto lanes = network::lanes;
+	typename network::vector registers[size / lanes];
+	for (std::size_t r = 0; r != size / lanes; ++r) {
+		registers[r] = network::load(values.data() + r * lanes);
+	}
+	::containers::simd_bitonic_step<T, size, 2, 1>(registers);
+	for (std::size_t r = 0; r != size / lanes; ++r) {
+		network::store(values.data() + r * lanes, registers[r]);
+	}
+}
+
+#else
+
+template<typename T>
+concept has_simd_network = false;
+
+#endif
+
+// Whether network_sort is faster than a general sort for this type. Without
+// vector instructions, the network does more work than an insertion sort.
+export template<typename T>
+constexpr auto prefer_network_sort = has_simd_network<T>;
+
+template<std::size_t padded_size, typename T>
+constexpr auto network_sort_padded(T * const first, std::size_t const size) -> void {
+	auto values = std::array<T, padded_size>();
+	std::copy_n(first, size, values.data());
+	std::fill(values.data() + size, values.data() + padded_size, network_padding_value<T>());
+	if consteval {
+		::containers::scalar_bitonic_sort(values);
+	} else {
+	#if defined(__AVX2__) or defined(__SSE4_1__)
+		if constexpr (has_simd_network<T>) {
+			::containers::simd_bitonic_sort(values);
+		} else {
+			::containers::scalar_bitonic_sort(values);
+		}
+	#else
+		::containers::scalar_bitonic_sort(values);
+	#endif
+	}
+	std::copy_n(values.data(), size, first);
+}
+
+struct network_sort_t {
+	template<range Range> requires network_sortable<Range, std::less<>>
+	static constexpr auto operator()(Range && to_sort) -> void {
+		auto const size = static_cast<std::size_t>(containers::size(to_sort));
+		BOUNDED_ASSERT(size <= max_network_sort_size);
+		auto const first = containers::data(to_sort);
+		if (size <= 1) {
+			return;
+		} else if (size <= 8) {
+			::containers::network_sort_padded<8>(first, size);
+		} else if (size <= 16) {
+			::containers::network_sort_padded<16>(first, size);
+		} else {
+			::containers::network_sort_padded<32>(first, size);
+		}
+		BOUNDED_ASSERT(::containers::is_sorted(to_sort));
+	}
+};
+export constexpr auto network_sort = network_sort_t();
+
+} // namespace containers
+
+using namespace containers_test;
+
+static_assert(test_sort(uint8_1, containers::network_sort));
+static_assert(test_sort(uint8_2, containers::network_sort));
+static_assert(test_sort(uint8_3, containers::network_sort));
+static_assert(test_sort(containers::array{uint8_many}, containers::network_sort));
+static_assert(test_sort(containers::array{uint16_many}, containers::network_sort));
+static_assert(test_sort(containers::array{uint32_many}, containers::network_sort));
+
+static_assert(test_sort(
+	containers::array{
+		sort_test_data(
+			containers::array{
+				9, -3, 27, 0, -30, 14, 8, 8, 1, -1,
+				31, 2, -17, 5, 6, 100, -100, 4, 3, 12,
+				11, 10, -2, 7, 13, 30, -31, 29, 28, 15,
+				-4, 16
+			},
+			containers::array{
+				-100, -31, -30, -17, -4, -3, -2, -1, 0, 1,
+				2, 3, 4, 5, 6, 7, 8, 8, 9, 10,
+				11, 12, 13, 14, 15, 16, 27, 28, 29, 30,
+				31, 100
+			}
+		)
+	},
+	containers::network_sort
+));
+
+static_assert(test_sort(
+	containers::array{
+		sort_test_data(
+			containers::array{2.5, -0.5, 1.0e10, -1.0e10, 3.0, 2.5, 0.0, -7.25, 1.5},
+			containers::array{-1.0e10, -7.25, -0.5, 0.0, 1.5, 2.5, 2.5, 3.0, 1.0e10}
+		)
+	},
+	containers::network_sort
+));
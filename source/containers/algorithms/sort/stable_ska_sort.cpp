@@ -0,0 +1,109 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+export module containers.algorithms.sort.stable_ska_sort;
+
+import containers.algorithms.sort.double_buffered_ska_sort;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.copy;
+import containers.algorithms.move_iterator;
+import containers.begin_end;
+import containers.extract_key_to_less;
+import containers.is_range;
+import containers.legacy_iterator;
+import containers.range_value_t;
+import containers.range_view;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace containers {
+
+// Whether double_buffered_ska_sort can sort by this key. It handles integers,
+// and tuples and fixed-size ranges of them, but not ranges that can have
+// different sizes.
+template<typename T, typename ExtractKey>
+consteval auto has_fixed_width_radix_key() -> bool {
+	using key_t = std::decay_t<std::invoke_result_t<ExtractKey const &, T>>;
+	if constexpr (std::same_as<key_t, bool> or bounded::unsigned_builtin<key_t>) {
+		return true;
+	} else if constexpr (range<key_t>) {
+		if constexpr (requires { key_t::size(); } or requires { std::tuple_size<key_t>::value; }) {
+			return ::containers::has_fixed_width_radix_key<range_value_t<key_t> const &, ExtractKey>();
+		} else {
+			return false;
+		}
+	} else if constexpr (tuple_like<key_t>) {
+		return []<std::size_t... indexes>(std::index_sequence<indexes...>) {
+			return (... and ::containers::has_fixed_width_radix_key<std::tuple_element_t<indexes, key_t> const &, ExtractKey>());
+		}(std::make_index_sequence<std::tuple_size_v<key_t>>());
+	} else {
+		return false;
+	}
+}
+
+template<typename Range, typename ExtractKey>
+constexpr auto stable_ska_sort_impl(Range && to_sort, ExtractKey const & extract_key) -> void {
+	auto const first = containers::begin(to_sort);
+	auto const last = containers::end(to_sort);
+	using value_type = range_value_t<Range>;
+	if constexpr (has_fixed_width_radix_key<value_type const &, ExtractKey>()) {
+		auto const view = range_view(first, last);
+		auto buffer = containers::vector<value_type>(range_view(
+			::containers::move_iterator(first),
+			::containers::move_iterator(last)
+		));
+		bool const sorted_into_view = ::containers::double_buffered_ska_sort(buffer, view, extract_key);
+		if (!sorted_into_view) {
+			::containers::copy(std::move(buffer), first);
+		}
+	} else {
+		std::stable_sort(
+			make_legacy_iterator(first),
+			make_legacy_iterator(last),
+			extract_key_to_less(extract_key)
+		);
+	}
+}
+
+// A key that is a single value, such as a signed or floating-point number, a
+// bounded integer or an enum, is sorted by its radix key, the same way
+// inplace_radix_sort sorts it
+template<typename Key>
+concept scalar_radix_key =
+	!range<Key> and
+	!tuple_like<Key> and
+	!std::same_as<Key, bool> and
+	!bounded::unsigned_builtin<Key> and
+	requires(Key const & key) { to_radix_sort_key(key); };
+
+// Sorts so that elements with equal keys keep their original order. This is
+// double_buffered_ska_sort with a buffer it allocates itself. The elements are
+// moved into the buffer first, so they do not need to be default
+// constructible. Keys that double_buffered_ska_sort cannot handle fall back to
+// std::stable_sort.
+struct stable_ska_sort_t {
+	template<range Range, typename ExtractKey>
+	static constexpr auto operator()(Range && to_sort, ExtractKey const & extract_key) -> void {
+		using value_type = range_value_t<Range>;
+		using key_t = std::decay_t<std::invoke_result_t<ExtractKey const &, value_type const &>>;
+		if constexpr (scalar_radix_key<key_t>) {
+			::containers::stable_ska_sort_impl(to_sort, [&](value_type const & value) {
+				return to_radix_sort_key(extract_key(value));
+			});
+		} else {
+			::containers::stable_ska_sort_impl(to_sort, extract_key);
+		}
+	}
+	template<range Range>
+	static constexpr auto operator()(Range && to_sort) -> void {
+		operator()(to_sort, to_radix_sort_key);
+	}
+};
+export constexpr auto stable_ska_sort = stable_ska_sort_t();
+
+} // namespace containers
@@ -0,0 +1,214 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.algorithms.sort.string_sort;
+
+import containers.algorithms.sort.common_prefix;
+import containers.algorithms.sort.sort;
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.test_sort_inplace_and_relocate;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.advance;
+import containers.array;
+import containers.begin_end;
+import containers.data;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.range_value_t;
+import containers.range_view;
+import containers.size;
+
+import bounded;
+import std_module;
+
+using namespace bounded::literal;
+
+namespace containers {
+
+template<typename Range, typename ExtractKey>
+using string_key_t = std::remove_cvref_t<std::invoke_result_t<ExtractKey const &, range_value_t<Range> const &>>;
+
+export template<typename Range, typename ExtractKey>
+concept string_sortable =
+	random_access_range<Range> and
+	random_access_range<string_key_t<Range, ExtractKey>> and
+	character<std::remove_cvref_t<range_value_t<string_key_t<Range, ExtractKey>>>>;
+
+// Below this size a comparison sort of the remaining suffixes is faster than
+// another partitioning pass
+constexpr auto string_sort_threshold = 16_bi;
+
+constexpr auto string_begin(auto const & key, std::size_t const depth) {
+	auto const first = containers::begin(key);
+	return first + ::bounded::assume_in_range<iter_difference_t<decltype(first)>>(depth);
+}
+
+// Past the end of a key is less than every character, so a key sorts before
+// every key that it is a prefix of.
+constexpr auto character_at(auto const & key, std::size_t const depth) -> std::int64_t {
+	if (static_cast<std::size_t>(containers::size(key)) <= depth) {
+		return -1;
+	}
+	return static_cast<std::int64_t>(to_radix_sort_key(*::containers::string_begin(key, depth)));
+}
+
+constexpr auto median_of_three(std::int64_t const a, std::int64_t const b, std::int64_t const c) -> std::int64_t {
+	return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+// Multikey quicksort. Each pass looks at only one character of each key, at
+// `depth`, and splits the range into keys with a smaller, equal or greater
+// character there. Only the middle group moves on to the next character, and
+// before it does, it skips every character that all of its keys have in
+// common. Every key in the range has at least `depth` characters, and they
+// are all equal.
+template<typename Iterator>
+constexpr auto multikey_quicksort(Iterator first, Iterator last, auto const & extract_key, std::size_t depth, int const recursion_limit) -> void {
+	while (true) {
+		auto const size = last - first;
+		if (size < string_sort_threshold or recursion_limit == 0) {
+			auto remaining = range_view(first, last);
+			::containers::sort(remaining, [&](auto const & lhs, auto const & rhs) {
+				auto const & lhs_key = extract_key(lhs);
+				auto const & rhs_key = extract_key(rhs);
+				return std::lexicographical_compare(
+					::containers::string_begin(lhs_key, depth),
+					containers::end(lhs_key),
+					::containers::string_begin(rhs_key, depth),
+					containers::end(rhs_key),
+					[](auto const lhs_character, auto const rhs_character) {
+						return to_radix_sort_key(lhs_character) < to_radix_sort_key(rhs_character);
+					}
+				);
+			});
+			return;
+		}
+		auto const character = [&](auto const & value) {
+			return ::containers::character_at(extract_key(value), depth);
+		};
+		auto const pivot = ::containers::median_of_three(
+			character(*first),
+			character(*(first + ::bounded::assume_in_range<iter_difference_t<Iterator>>(size / 2_bi))),
+			character(*containers::prev(last))
+		);
+		auto less_end = first;
+		auto it = first;
+		auto greater_begin = last;
+		while (it != greater_begin) {
+			auto const current = character(*it);
+			if (current < pivot) {
+				std::ranges::swap(*less_end, *it);
+				++less_end;
+				++it;
+			} else if (pivot < current) {
+				--greater_begin;
+				std::ranges::swap(*it, *greater_begin);
+			} else {
+				++it;
+			}
+		}
+		::containers::multikey_quicksort(first, less_end, extract_key, depth, recursion_limit - 1);
+		::containers::multikey_quicksort(greater_begin, last, extract_key, depth, recursion_limit - 1);
+		if (pivot == -1) {
+			return;
+		}
+		first = less_end;
+		last = greater_begin;
+		++depth;
+		depth += ::containers::common_prefix(
+			range_view(first, last),
+			extract_key,
+			to_radix_sort_key,
+			::bounded::assume_in_range<iter_difference_t<decltype(containers::begin(extract_key(*first)))>>(depth)
+		);
+	}
+}
+
+// Sorts keys that are strings of characters in lexicographical order, with a
+// shorter key before any longer key that starts with it. This gives the same
+// order as ska_sort, but it never reads a character before the first one that
+// is not shared by the whole bucket. Not stable.
+struct string_sort_t {
+	template<range Range, typename ExtractKey> requires string_sortable<Range, ExtractKey>
+	static constexpr auto operator()(Range && to_sort, ExtractKey const & extract_key) -> void {
+		auto const first = containers::begin(to_sort);
+		auto const last = containers::end(to_sort);
+		if (last - first <= 1_bi) {
+			return;
+		}
+		auto const depth = ::containers::common_prefix(
+			range_view(first, last),
+			extract_key,
+			to_radix_sort_key,
+			::bounded::assume_in_range<iter_difference_t<decltype(containers::begin(extract_key(*first)))>>(0_bi)
+		);
+		auto const recursion_limit = 2 * std::bit_width(static_cast<std::size_t>(last - first));
+		::containers::multikey_quicksort(first, last, extract_key, depth, recursion_limit);
+	}
+	template<range Range> requires string_sortable<Range, to_radix_sort_key_t>
+	static constexpr auto operator()(Range && to_sort) -> void {
+		operator()(to_sort, to_radix_sort_key);
+	}
+};
+export constexpr auto string_sort = string_sort_t();
+
+} // namespace containers
+
+using namespace containers_test;
+using namespace std::string_view_literals;
+
+static_assert(test_sort(containers::array{strings}, containers::string_sort));
+
+static_assert([] {
+	// Enough keys that they are partitioned, with long shared prefixes, keys
+	// that are prefixes of other keys, duplicates and non-ASCII characters
+	auto input = containers::array{
+		"https://www.example.com/b"sv,
+		"https://www.example.com/a"sv,
+		"https://www.example.com/"sv,
+		"https://www.example.com/ab"sv,
+		"https://www.example.org/"sv,
+		"https://www.example.com/a"sv,
+		"http://example.com"sv,
+		"https://www.example.com/\xff"sv,
+		"https://www.example.com/aa"sv,
+		"https://www.example.org/z"sv,
+		"https://"sv,
+		"https://www.example.com/ba"sv,
+		""sv,
+		"https://www.example.com/abc"sv,
+		"http://"sv,
+		"https://www.example.org/"sv,
+		"https://www.example.com/b"sv,
+		"https://www.example.com/a\x80"sv,
+		"http://example.com/"sv,
+		"https://www.example.net/"sv,
+		"h"sv,
+		"https://www.example.com/c"sv,
+		"https://www.example.com/B"sv,
+		"https://www.example.com/abd"sv,
+	};
+	auto expected = input;
+	std::sort(containers::data(expected), containers::data(expected) + containers::size(expected), [](std::string_view const lhs, std::string_view const rhs) {
+		return std::lexicographical_compare(
+			lhs.begin(),
+			lhs.end(),
+			rhs.begin(),
+			rhs.end(),
+			[](char const a, char const b) { return static_cast<unsigned char>(a) < static_cast<unsigned char>(b); }
+		);
+	});
+	containers::string_sort(input);
+	return input == expected;
+}());
+
+static_assert(containers::string_sortable<containers::array<std::string_view, 1_bi>, containers::to_radix_sort_key_t>);
+static_assert(!containers::string_sortable<containers::array<int, 1_bi>, containers::to_radix_sort_key_t>);
+static_assert(!containers::string_sortable<containers::array<containers::array<int, 2_bi>, 1_bi>, containers::to_radix_sort_key_t>);
@@ -46,8 +46,8 @@ using float_to_unsigned =
 	unknown_floating_point
 >>>;
 
-template<typename T>
-concept character = 
+export template<typename T>
+concept character =
 	std::same_as<T, char> or
 	std::same_as<T, char8_t> or
 	std::same_as<T, char16_t> or
@@ -77,8 +77,29 @@ constexpr auto to_radix_sort_key(T const value) {
 	}
 }
 
-constexpr auto to_radix_sort_key(bounded::bounded_integer auto const value) {
-	return to_radix_sort_key(value.value());
+template<typename Key>
+constexpr auto fits_in_radix_key(auto const range) -> bool {
+	return range <= bounded::constant<numeric_traits::max_value<Key>>;
+}
+
+// The range of a bounded::integer is known at compile time, so the key is the
+// distance from the minimum in the narrowest type that can hold it. Radix sorts
+// then never spend passes on bytes that are the same for every possible value.
+template<bounded::bounded_integer T>
+constexpr auto to_radix_sort_key(T const value) {
+	constexpr auto min = numeric_traits::min_value<T>;
+	constexpr auto range = numeric_traits::max_value<T> - min;
+	if constexpr (fits_in_radix_key<std::uint8_t>(range)) {
+		return static_cast<std::uint8_t>(value - min);
+	} else if constexpr (fits_in_radix_key<std::uint16_t>(range)) {
+		return static_cast<std::uint16_t>(value - min);
+	} else if constexpr (fits_in_radix_key<std::uint32_t>(range)) {
+		return static_cast<std::uint32_t>(value - min);
+	} else if constexpr (fits_in_radix_key<std::uint64_t>(range)) {
+		return static_cast<std::uint64_t>(value - min);
+	} else {
+		return to_radix_sort_key(value.value());
+	}
 }
 
 template<typename T> requires std::is_enum_v<T>
@@ -360,3 +381,47 @@ static_assert(is_sorted_converted_to_radix<tv::tuple<std::byte>>(
 	tv::tuple(std::byte(0xFF))
 ));
 
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::integer<0, 255>())), std::uint8_t>);
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::integer<1000, 1255>())), std::uint8_t>);
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::integer<-128, 127>())), std::uint8_t>);
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::integer<1000, 1256>())), std::uint16_t>);
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::integer<-1, 65534>())), std::uint16_t>);
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::integer<0, 65536>())), std::uint32_t>);
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::integer<-1, 4'294'967'295>())), std::uint64_t>);
+static_assert(std::same_as<decltype(containers::to_radix_sort_key(bounded::constant<5>)), std::uint8_t>);
+
+static_assert(containers::to_radix_sort_key(bounded::integer<1000, 1255>(bounded::constant<1000>)) == 0);
+static_assert(containers::to_radix_sort_key(bounded::integer<1000, 1255>(bounded::constant<1255>)) == 255);
+
+template<typename T>
+constexpr auto is_sorted_bounded_to_radix(auto... values) {
+	return is_sorted_to_radix(bounded::assume_in_range<T>(values)...);
+}
+
+static_assert(is_sorted_bounded_to_radix<bounded::integer<1000, 1255>>(
+	1000,
+	1001,
+	1100,
+	1254,
+	1255
+));
+
+static_assert(is_sorted_bounded_to_radix<bounded::integer<-300, 300>>(
+	-300,
+	-256,
+	-1,
+	0,
+	1,
+	255,
+	256,
+	300
+));
+
+static_assert(is_sorted_bounded_to_radix<bounded::integer<numeric_traits::min_value<std::int64_t>, numeric_traits::max_value<std::int64_t>>>(
+	numeric_traits::min_value<std::int64_t>,
+	-1,
+	0,
+	1,
+	numeric_traits::max_value<std::int64_t>
+));
+
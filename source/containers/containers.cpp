@@ -5,10 +5,22 @@
 
 export module containers;
 
+export import containers.algorithms.sort.counting_sort;
 export import containers.algorithms.sort.double_buffered_ska_sort;
+export import containers.algorithms.sort.external_sort;
 export import containers.algorithms.sort.is_sorted;
+export import containers.algorithms.sort.key_cached_sort;
+export import containers.algorithms.sort.lsd_radix_sort;
+export import containers.algorithms.sort.nth_element;
+export import containers.algorithms.sort.parallel_ska_sort;
+export import containers.algorithms.sort.radix_select;
 export import containers.algorithms.sort.ska_sort;
 export import containers.algorithms.sort.sort;
+export import containers.algorithms.sort.sort_permutation;
+export import containers.algorithms.sort.sort_tuning;
+export import containers.algorithms.sort.sorting_network;
+export import containers.algorithms.sort.stable_ska_sort;
+export import containers.algorithms.sort.string_sort;
 export import containers.algorithms.sort.to_radix_sort_key;
 
 export import containers.algorithms.accumulate;
@@ -27,12 +39,14 @@ export import containers.algorithms.erase;
 export import containers.algorithms.filter;
 export import containers.algorithms.find;
 export import containers.algorithms.generate;
+export import containers.algorithms.interpolation_search;
 export import containers.algorithms.keyed_binary_search;
 export import containers.algorithms.keyed_erase;
 export import containers.algorithms.keyed_insert;
 export import containers.algorithms.maybe_find;
 export import containers.algorithms.minmax_element;
 export import containers.algorithms.move_iterator;
+export import containers.algorithms.parallel_for_each_index;
 export import containers.algorithms.partition;
 export import containers.algorithms.remove_none;
 export import containers.algorithms.reverse;
@@ -57,10 +71,14 @@ export import containers.can_set_size;
 export import containers.clear;
 export import containers.common_iterator_functions;
 export import containers.data;
+export import containers.direct_map;
 export import containers.dynamic_array;
 export import containers.emplace_back;
+export import containers.eytzinger_map;
 export import containers.flat_map;
 export import containers.front_back;
+export import containers.frozen_map;
+export import containers.hash_map;
 export import containers.index_type;
 export import containers.initializer_range;
 export import containers.insert;
@@ -93,6 +111,8 @@ export import containers.resizable_container;
 export import containers.resize;
 export import containers.size;
 export import containers.size_then_use_range;
+export import containers.soa_flat_map;
+export import containers.split_linear_map;
 export import containers.stable_vector;
 export import containers.static_vector;
 export import containers.string;
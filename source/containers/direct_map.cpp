@@ -0,0 +1,665 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+#include <operators/forward.hpp>
+
+export module containers.direct_map;
+
+import containers.algorithms.compare;
+import containers.array;
+import containers.associative_container;
+import containers.begin_end;
+import containers.c_array;
+import containers.data;
+import containers.hash_map;
+import containers.is_range;
+import containers.lookup;
+import containers.map_tags;
+import containers.map_value_type;
+import containers.repeat_n;
+import containers.size;
+import containers.uninitialized_dynamic_array;
+import containers.vector;
+export import containers.common_iterator_functions;
+
+import bounded;
+import bounded.test_int;
+import numeric_traits;
+import std_module;
+
+namespace containers {
+
+template<typename Key>
+constexpr auto number_of_slots = static_cast<std::size_t>(bounded::number_of<Key>);
+
+template<typename Key>
+constexpr auto key_to_index(Key const key) -> std::size_t {
+	return static_cast<std::size_t>(bounded::integer(key) - bounded::constant<numeric_traits::min_value<Key>>);
+}
+
+template<typename Key>
+constexpr auto index_to_key(std::size_t const index) -> Key {
+	auto const offset = ::bounded::assume_in_range(index, bounded::constant<0>, bounded::number_of<Key> - bounded::constant<1>);
+	return static_cast<Key>(offset + bounded::constant<numeric_traits::min_value<Key>>);
+}
+
+constexpr auto bits_per_word = std::size_t(64);
+
+constexpr auto words_for(std::size_t const bits) -> std::size_t {
+	return (bits + bits_per_word - 1U) / bits_per_word;
+}
+
+constexpr auto is_bit_set(std::uint64_t const * const words, std::size_t const index) -> bool {
+	return ((words[index / bits_per_word] >> (index % bits_per_word)) & 1U) != 0U;
+}
+
+// Returns the first set bit at or after `index`, or `size` if there is none.
+// Bits past `size` must be clear.
+constexpr auto next_set_bit(std::uint64_t const * const words, std::size_t const index, std::size_t const size) -> std::size_t {
+	if (index >= size) {
+		return size;
+	}
+	auto word_index = index / bits_per_word;
+	auto word = words[word_index] & (~std::uint64_t(0) << (index % bits_per_word));
+	auto const word_count = ::containers::words_for(size);
+	while (word == 0U) {
+		++word_index;
+		if (word_index == word_count) {
+			return size;
+		}
+		word = words[word_index];
+	}
+	return word_index * bits_per_word + static_cast<std::size_t>(std::countr_zero(word));
+}
+
+template<typename Key>
+concept has_spare_representation = bounded::tombstone_traits<Key>::spare_representations != bounded::constant<0>;
+
+// Every slot holds a `hash_map_value`, and a slot without an element holds a
+// key that is not valid
+template<typename Value>
+struct tombstone_direct_storage {
+	using value_type = Value;
+
+	constexpr auto capacity() const -> std::size_t {
+		return static_cast<std::size_t>(containers::size(m_slots));
+	}
+	constexpr auto slots() const -> Value const * {
+		return containers::data(m_slots);
+	}
+	constexpr auto slots() -> Value * {
+		return containers::data(m_slots);
+	}
+
+	constexpr auto allocate(std::size_t const capacity_) -> void {
+		m_slots = slots_t(containers::repeat_n(
+			::bounded::assume_in_range<range_size_t<slots_t>>(capacity_),
+			traits::make(bounded::constant<0>)
+		));
+	}
+
+	constexpr auto contains(std::size_t const index) const -> bool {
+		return traits::index(slots()[index]) == bounded::constant<-1>;
+	}
+	constexpr auto next_full(std::size_t index) const -> std::size_t {
+		auto const capacity_ = capacity();
+		while (index != capacity_ and !contains(index)) {
+			++index;
+		}
+		return index;
+	}
+
+	constexpr auto construct(std::size_t const index, auto && make) -> void {
+		auto & slot = slots()[index];
+		bounded::destroy(slot);
+		try {
+			bounded::construct_at(slot, OPERATORS_FORWARD(make));
+		} catch (...) {
+			bounded::construct_at(slot, [] { return traits::make(bounded::constant<0>); });
+			throw;
+		}
+	}
+	constexpr auto erase(std::size_t const index) -> void {
+		auto & slot = slots()[index];
+		bounded::destroy(slot);
+		bounded::construct_at(slot, [] { return traits::make(bounded::constant<0>); });
+	}
+
+private:
+	using traits = bounded::tombstone_traits<Value>;
+	using slots_t = containers::vector<Value>;
+
+	slots_t m_slots;
+};
+
+// For keys that have no spare representation, one bit for each slot says
+// whether it holds an element
+template<typename Value>
+struct bitmap_direct_storage {
+	using value_type = Value;
+
+	bitmap_direct_storage() = default;
+	constexpr bitmap_direct_storage(bitmap_direct_storage const & other) requires std::is_copy_constructible_v<Value>:
+		bitmap_direct_storage()
+	{
+		if (other.capacity() == 0U) {
+			return;
+		}
+		allocate(other.capacity());
+		for (auto index = other.next_full(0U); index != other.capacity(); index = other.next_full(index + 1U)) {
+			construct(index, [&] -> Value const & { return other.slots()[index]; });
+		}
+	}
+	constexpr bitmap_direct_storage(bitmap_direct_storage && other) noexcept:
+		m_present(std::move(other.m_present)),
+		m_slots(std::move(other.m_slots)),
+		m_capacity(std::exchange(other.m_capacity, 0U))
+	{
+	}
+
+	constexpr auto operator=(bitmap_direct_storage const & other) & -> bitmap_direct_storage & requires std::is_copy_constructible_v<Value> {
+		if (this != std::addressof(other)) {
+			*this = bitmap_direct_storage(other);
+		}
+		return *this;
+	}
+	constexpr auto operator=(bitmap_direct_storage && other) & noexcept -> bitmap_direct_storage & {
+		if (this != std::addressof(other)) {
+			destroy_elements();
+			m_present = std::move(other.m_present);
+			m_slots = std::move(other.m_slots);
+			m_capacity = std::exchange(other.m_capacity, 0U);
+		}
+		return *this;
+	}
+
+	constexpr ~bitmap_direct_storage() {
+		destroy_elements();
+	}
+
+	// `uninitialized_dynamic_array` keeps its capacity after it is moved from,
+	// so this tracks the capacity separately
+	constexpr auto capacity() const -> std::size_t {
+		return m_capacity;
+	}
+	constexpr auto slots() const -> Value const * {
+		return m_slots.data();
+	}
+	constexpr auto slots() -> Value * {
+		return m_slots.data();
+	}
+
+	constexpr auto allocate(std::size_t const capacity_) -> void {
+		m_present = present_t(containers::repeat_n(
+			::bounded::assume_in_range<range_size_t<present_t>>(::containers::words_for(capacity_)),
+			std::uint64_t(0)
+		));
+		m_slots = uninitialized_dynamic_array<Value, std::size_t>(capacity_);
+		m_capacity = capacity_;
+	}
+
+	constexpr auto contains(std::size_t const index) const -> bool {
+		return ::containers::is_bit_set(containers::data(m_present), index);
+	}
+	constexpr auto next_full(std::size_t const index) const -> std::size_t {
+		return ::containers::next_set_bit(containers::data(m_present), index, capacity());
+	}
+
+	constexpr auto construct(std::size_t const index, auto && make) -> void {
+		bounded::construct_at(slots()[index], OPERATORS_FORWARD(make));
+		containers::data(m_present)[index / bits_per_word] |= std::uint64_t(1) << (index % bits_per_word);
+	}
+	constexpr auto erase(std::size_t const index) -> void {
+		bounded::destroy(slots()[index]);
+		containers::data(m_present)[index / bits_per_word] &= ~(std::uint64_t(1) << (index % bits_per_word));
+	}
+
+private:
+	using present_t = containers::vector<std::uint64_t>;
+
+	constexpr auto destroy_elements() -> void {
+		for (auto index = next_full(0U); index != capacity(); index = next_full(index + 1U)) {
+			bounded::destroy(slots()[index]);
+		}
+	}
+
+	present_t m_present;
+	uninitialized_dynamic_array<Value, std::size_t> m_slots;
+	std::size_t m_capacity = 0;
+};
+
+// A map with a slot for every value of `Key`, so finding a key is an index
+// into an array. `Key` can be a `bounded::integer` or an enum with
+// `numeric_traits::min_value` and `numeric_traits::max_value`, and should have
+// a small range: the slots are allocated on the first insertion.
+//
+// If the key has a spare representation, each slot is a `hash_map_value`, and
+// a key that is not valid marks an empty slot. Otherwise a bitmap says which
+// slots are full. Iteration is in order of the keys, like `flat_map`.
+export template<bounded::isomorphic_to_integral Key, typename Mapped>
+class direct_map {
+public:
+	using key_type = Key;
+	using mapped_type = Mapped;
+	using value_type = std::conditional_t<
+		has_spare_representation<Key>,
+		hash_map_value<Key, Mapped>,
+		map_value_type<Key, Mapped>
+	>;
+
+private:
+	using storage_t = std::conditional_t<
+		has_spare_representation<Key>,
+		tombstone_direct_storage<value_type>,
+		bitmap_direct_storage<value_type>
+	>;
+	using size_type = bounded::integer<0, bounded::normalize<bounded::number_of<Key>>>;
+
+public:
+	using const_iterator = hash_map_iterator<storage_t const>;
+	using iterator = hash_map_iterator<storage_t>;
+
+	direct_map() = default;
+	direct_map(direct_map const &) = default;
+	constexpr direct_map(direct_map && other) noexcept:
+		m_storage(std::move(other.m_storage)),
+		m_size(std::exchange(other.m_size, bounded::constant<0>))
+	{
+	}
+	auto operator=(direct_map const &) & -> direct_map & = default;
+	constexpr auto operator=(direct_map && other) & noexcept -> direct_map & {
+		m_storage = std::move(other.m_storage);
+		m_size = std::exchange(other.m_size, bounded::constant<0>);
+		return *this;
+	}
+
+	template<range Source> requires(!std::same_as<std::remove_cvref_t<Source>, direct_map>)
+	constexpr explicit direct_map(Source && source) {
+		insert(OPERATORS_FORWARD(source));
+	}
+	template<std::size_t init_size>
+	constexpr direct_map(c_array<value_type, init_size> && source) {
+		for (auto & value : source) {
+			lazy_insert(std::move(value.key), [&] -> Mapped && { return std::move(value.mapped); });
+		}
+	}
+
+	constexpr auto begin() const -> const_iterator {
+		return const_iterator(m_storage, m_storage.next_full(0U));
+	}
+	constexpr auto begin() -> iterator {
+		return iterator(m_storage, m_storage.next_full(0U));
+	}
+	constexpr auto end() const -> const_iterator {
+		return const_iterator(m_storage, m_storage.capacity());
+	}
+	constexpr auto end() -> iterator {
+		return iterator(m_storage, m_storage.capacity());
+	}
+	constexpr auto size() const -> size_type {
+		return m_size;
+	}
+
+	constexpr auto find(key_type const key) const -> const_iterator {
+		auto const index = ::containers::key_to_index(key);
+		return m_storage.capacity() != 0U and m_storage.contains(index) ?
+			const_iterator(m_storage, index) :
+			end();
+	}
+	constexpr auto find(key_type const key) -> iterator {
+		auto const index = ::containers::key_to_index(key);
+		return m_storage.capacity() != 0U and m_storage.contains(index) ?
+			iterator(m_storage, index) :
+			end();
+	}
+
+	constexpr auto lazy_insert(key_type const key, bounded::construct_function_for<mapped_type> auto && mapped) -> inserted_t<iterator> {
+		if (m_storage.capacity() == 0U) {
+			m_storage.allocate(number_of_slots<Key>);
+		}
+		auto const index = ::containers::key_to_index(key);
+		if (m_storage.contains(index)) {
+			return inserted_t{iterator(m_storage, index), false};
+		}
+		m_storage.construct(index, [&] {
+			return value_type{key, OPERATORS_FORWARD(mapped)()};
+		});
+		++m_size;
+		return inserted_t{iterator(m_storage, index), true};
+	}
+
+	template<range Range>
+	constexpr auto insert(Range && init) -> void {
+		for (auto && value : OPERATORS_FORWARD(init)) {
+			lazy_insert(
+				get_key(value),
+				[&] -> decltype(auto) { return get_mapped(OPERATORS_FORWARD(value)); }
+			);
+		}
+	}
+
+	constexpr auto erase(const_iterator const it) -> iterator {
+		m_storage.erase(it.index());
+		--m_size;
+		return iterator(m_storage, m_storage.next_full(it.index() + 1U));
+	}
+	constexpr auto erase(const_iterator first, const_iterator const last) -> iterator {
+		while (first != last) {
+			first = erase(first);
+		}
+		return iterator(m_storage, last.index());
+	}
+	constexpr auto erase_if(auto const predicate) -> void {
+		for (auto it = begin(); it != end();) {
+			if (predicate(*it)) {
+				it = erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	friend constexpr auto operator==(direct_map const & lhs, direct_map const & rhs) -> bool {
+		return lhs.size() == rhs.size() and ::containers::equal(lhs, rhs);
+	}
+
+private:
+	storage_t m_storage;
+	size_type m_size = bounded::constant<0>;
+};
+
+export template<bounded::isomorphic_to_integral Key>
+struct direct_set_iterator {
+	using difference_type = bounded::integer<
+		-bounded::normalize<bounded::number_of<Key>>,
+		bounded::normalize<bounded::number_of<Key>>
+	>;
+
+	direct_set_iterator() = default;
+	constexpr direct_set_iterator(std::uint64_t const * const words, std::size_t const size, std::size_t const index):
+		m_words(words),
+		m_size(size),
+		m_index(index)
+	{
+	}
+
+	constexpr auto index() const -> std::size_t {
+		return m_index;
+	}
+
+	constexpr auto operator*() const -> Key {
+		return ::containers::index_to_key<Key>(m_index);
+	}
+
+	friend auto operator==(direct_set_iterator, direct_set_iterator) -> bool = default;
+
+	friend constexpr auto operator+(direct_set_iterator const it, bounded::constant_t<1>) -> direct_set_iterator {
+		return direct_set_iterator(it.m_words, it.m_size, ::containers::next_set_bit(it.m_words, it.m_index + 1U, it.m_size));
+	}
+
+private:
+	std::uint64_t const * m_words = nullptr;
+	std::size_t m_size = 0;
+	std::size_t m_index = 0;
+};
+
+// A set of values of `Key` stored as one bit for each value. The bits are
+// allocated on the first insertion.
+export template<bounded::isomorphic_to_integral Key>
+class direct_set {
+private:
+	using size_type = bounded::integer<0, bounded::normalize<bounded::number_of<Key>>>;
+
+public:
+	using key_type = Key;
+	using value_type = Key;
+	using const_iterator = direct_set_iterator<Key>;
+
+	direct_set() = default;
+	direct_set(direct_set const &) = default;
+	constexpr direct_set(direct_set && other) noexcept:
+		m_present(std::move(other.m_present)),
+		m_size(std::exchange(other.m_size, bounded::constant<0>))
+	{
+	}
+	auto operator=(direct_set const &) & -> direct_set & = default;
+	constexpr auto operator=(direct_set && other) & noexcept -> direct_set & {
+		m_present = std::move(other.m_present);
+		m_size = std::exchange(other.m_size, bounded::constant<0>);
+		return *this;
+	}
+
+	template<range Source> requires(!std::same_as<std::remove_cvref_t<Source>, direct_set>)
+	constexpr explicit direct_set(Source && source) {
+		insert(OPERATORS_FORWARD(source));
+	}
+	template<std::size_t init_size>
+	constexpr direct_set(c_array<Key, init_size> && source) {
+		insert(source);
+	}
+
+	constexpr auto begin() const -> const_iterator {
+		return const_iterator(words(), allocated_size(), ::containers::next_set_bit(words(), 0U, allocated_size()));
+	}
+	constexpr auto end() const -> const_iterator {
+		return const_iterator(words(), allocated_size(), allocated_size());
+	}
+	constexpr auto size() const -> size_type {
+		return m_size;
+	}
+
+	constexpr auto find(key_type const key) const -> const_iterator {
+		auto const index = ::containers::key_to_index(key);
+		return allocated_size() != 0U and ::containers::is_bit_set(words(), index) ?
+			const_iterator(words(), allocated_size(), index) :
+			end();
+	}
+
+	constexpr auto insert(key_type const key) -> inserted_t<const_iterator> {
+		if (allocated_size() == 0U) {
+			m_present = present_t(containers::repeat_n(
+				::bounded::assume_in_range<range_size_t<present_t>>(::containers::words_for(number_of_slots<Key>)),
+				std::uint64_t(0)
+			));
+		}
+		auto const index = ::containers::key_to_index(key);
+		auto & word = containers::data(m_present)[index / bits_per_word];
+		auto const bit = std::uint64_t(1) << (index % bits_per_word);
+		auto const inserted = (word & bit) == 0U;
+		if (inserted) {
+			word |= bit;
+			++m_size;
+		}
+		return inserted_t{const_iterator(words(), allocated_size(), index), inserted};
+	}
+	template<range Range>
+	constexpr auto insert(Range && init) -> void {
+		for (auto const key : init) {
+			insert(key);
+		}
+	}
+
+	constexpr auto erase(const_iterator const it) -> const_iterator {
+		auto const index = it.index();
+		containers::data(m_present)[index / bits_per_word] &= ~(std::uint64_t(1) << (index % bits_per_word));
+		--m_size;
+		return const_iterator(words(), allocated_size(), ::containers::next_set_bit(words(), index + 1U, allocated_size()));
+	}
+	constexpr auto erase(const_iterator first, const_iterator const last) -> const_iterator {
+		while (first != last) {
+			first = erase(first);
+		}
+		return last;
+	}
+
+	friend constexpr auto operator==(direct_set const & lhs, direct_set const & rhs) -> bool {
+		return lhs.size() == rhs.size() and ::containers::equal(lhs, rhs);
+	}
+
+private:
+	using present_t = containers::vector<std::uint64_t>;
+
+	constexpr auto words() const -> std::uint64_t const * {
+		return containers::data(m_present);
+	}
+	constexpr auto allocated_size() const -> std::size_t {
+		return containers::size(m_present) == bounded::constant<0> ? 0U : number_of_slots<Key>;
+	}
+
+	present_t m_present;
+	size_type m_size = bounded::constant<0>;
+};
+
+} // namespace containers
+
+using namespace bounded::literal;
+
+enum class color { red, green, blue, yellow };
+
+template<std::same_as<color> T>
+constexpr auto numeric_traits::min_value<T> = color::red;
+
+template<std::same_as<color> T>
+constexpr auto numeric_traits::max_value<T> = color::yellow;
+
+using symbol = bounded::integer<0, 4095>;
+using small_key = bounded::integer<10, 137>;
+
+static_assert(std::same_as<containers::direct_map<symbol, int>::value_type, containers::hash_map_value<symbol, int>>);
+static_assert(std::same_as<containers::direct_map<color, int>::value_type, containers::map_value_type<color, int>>);
+static_assert(containers::associative_container<containers::direct_map<symbol, int>>);
+static_assert(containers::associative_container<containers::direct_map<color, int>>);
+
+template<typename Key>
+constexpr auto make_key(int const key) -> Key {
+	return static_cast<Key>(bounded::assume_in_range(
+		bounded::integer(key),
+		bounded::integer(numeric_traits::min_value<Key>),
+		bounded::integer(numeric_traits::max_value<Key>)
+	));
+}
+
+template<typename Key>
+constexpr auto test_direct_map(int const first, int const last) -> bool {
+	using map_type = containers::direct_map<Key, bounded_test::integer>;
+	auto map = map_type();
+	BOUNDED_ASSERT(map.find(make_key<Key>(first)) == containers::end(map));
+	for (auto key = last; key >= first; key -= 2) {
+		BOUNDED_ASSERT(map.lazy_insert(make_key<Key>(key), [=] { return bounded_test::integer(key * 2); }).inserted);
+	}
+	BOUNDED_ASSERT(!map.lazy_insert(make_key<Key>(last), [] { return bounded_test::integer(-1); }).inserted);
+	for (auto key = first; key <= last; ++key) {
+		auto const mapped = containers::lookup(map, make_key<Key>(key));
+		if ((last - key) % 2 == 0) {
+			BOUNDED_ASSERT(mapped and *mapped == bounded_test::integer(key * 2));
+		} else {
+			BOUNDED_ASSERT(mapped == nullptr);
+		}
+	}
+	// Iteration is in order of the keys
+	auto expected = (last - first) % 2 == 0 ? first : first + 1;
+	for (auto const & value : map) {
+		BOUNDED_ASSERT(value.key == make_key<Key>(expected));
+		BOUNDED_ASSERT(value.mapped == bounded_test::integer(expected * 2));
+		expected += 2;
+	}
+	BOUNDED_ASSERT(expected == last + 2);
+
+	auto const copy = map;
+	BOUNDED_ASSERT(copy == map);
+	map.erase(map.find(make_key<Key>(last)));
+	BOUNDED_ASSERT(map.find(make_key<Key>(last)) == containers::end(map));
+	BOUNDED_ASSERT(map.size() == copy.size() - 1_bi);
+	BOUNDED_ASSERT(copy != map);
+	map.erase_if([](auto const &) { return true; });
+	BOUNDED_ASSERT(map.size() == 0_bi and containers::begin(map) == containers::end(map));
+	return true;
+}
+
+static_assert(test_direct_map<symbol>(0, 200));
+static_assert(test_direct_map<symbol>(3900, 4095));
+static_assert(test_direct_map<small_key>(10, 137));
+static_assert(test_direct_map<color>(0, 3));
+static_assert(test_direct_map<bounded::integer<0, 255>>(0, 255));
+
+// Assignment replaces the elements of the target, and moving leaves the source
+// empty
+template<typename Key>
+constexpr auto test_assignment() -> bool {
+	using map_type = containers::direct_map<Key, bounded_test::integer>;
+	auto source = map_type();
+	source.lazy_insert(make_key<Key>(1), [] { return bounded_test::integer(10); });
+	source.lazy_insert(make_key<Key>(3), [] { return bounded_test::integer(30); });
+	auto target = map_type();
+	target.lazy_insert(make_key<Key>(2), [] { return bounded_test::integer(20); });
+	target = source;
+	BOUNDED_ASSERT(target == source);
+	BOUNDED_ASSERT(!containers::lookup(target, make_key<Key>(2)));
+
+	auto moved_to = map_type();
+	moved_to.lazy_insert(make_key<Key>(0), [] { return bounded_test::integer(0); });
+	moved_to = std::move(source);
+	BOUNDED_ASSERT(moved_to == target);
+	BOUNDED_ASSERT(source.size() == 0_bi and containers::begin(source) == containers::end(source));
+	source.lazy_insert(make_key<Key>(2), [] { return bounded_test::integer(20); });
+	BOUNDED_ASSERT(source.size() == 1_bi);
+
+	auto const constructed = std::move(moved_to);
+	BOUNDED_ASSERT(constructed == target);
+	BOUNDED_ASSERT(moved_to.size() == 0_bi and containers::begin(moved_to) == containers::end(moved_to));
+	return true;
+}
+
+static_assert(test_assignment<symbol>());
+static_assert(test_assignment<color>());
+
+static_assert([] {
+	auto set = containers::direct_set<color>({color::red, color::blue});
+	auto target = containers::direct_set<color>({color::green});
+	target = set;
+	BOUNDED_ASSERT(target == set);
+	auto moved_to = std::move(set);
+	BOUNDED_ASSERT(moved_to == target);
+	BOUNDED_ASSERT(set.size() == 0_bi and containers::begin(set) == containers::end(set));
+	return true;
+}());
+
+static_assert([] {
+	auto map = containers::direct_map<symbol, bounded_test::non_copyable_integer>();
+	map.lazy_insert(5_bi, [] { return bounded_test::non_copyable_integer(50); });
+	auto const moved = std::move(map);
+	return *containers::lookup(moved, 5_bi) == bounded_test::non_copyable_integer(50);
+}());
+
+static_assert([] {
+	auto const map = containers::direct_map<color, int>({{color::blue, 3}, {color::red, 1}});
+	return containers::equal(
+		map,
+		containers::array<containers::map_value_type<color, int>, 2_bi>({{color::red, 1}, {color::blue, 3}})
+	);
+}());
+
+static_assert([] {
+	auto set = containers::direct_set<small_key>();
+	BOUNDED_ASSERT(set.find(20_bi) == containers::end(set));
+	BOUNDED_ASSERT(set.insert(20_bi).inserted);
+	BOUNDED_ASSERT(set.insert(137_bi).inserted);
+	BOUNDED_ASSERT(set.insert(10_bi).inserted);
+	BOUNDED_ASSERT(!set.insert(20_bi).inserted);
+	BOUNDED_ASSERT(set.size() == 3_bi);
+	BOUNDED_ASSERT(containers::equal(set, containers::array<small_key, 3_bi>({10_bi, 20_bi, 137_bi})));
+	set.erase(set.find(20_bi));
+	BOUNDED_ASSERT(containers::equal(set, containers::array<small_key, 2_bi>({10_bi, 137_bi})));
+	return true;
+}());
+
+static_assert(containers::equal(
+	containers::direct_set<color>({color::yellow, color::green, color::yellow}),
+	containers::array{color::green, color::yellow}
+));
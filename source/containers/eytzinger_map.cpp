@@ -0,0 +1,250 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+#include <operators/forward.hpp>
+
+export module containers.eytzinger_map;
+
+import containers.algorithms.sort.is_sorted;
+import containers.algorithms.sort.ska_sort;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.compare;
+import containers.array;
+import containers.associative_container;
+import containers.begin_end;
+import containers.c_array;
+import containers.data;
+import containers.extract_key_to_less;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.iterator_t;
+import containers.lookup;
+import containers.map_tags;
+import containers.map_value_type;
+import containers.push_back;
+import containers.repeat_n;
+import containers.size;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace containers {
+
+// Fills `positions` so that `positions[n]` is the index in sorted order of the
+// element in slot `n` of the Eytzinger layout. That layout is the order of a
+// breadth-first walk of a complete binary search tree, so the children of the
+// slot `n` are the slots `2 * n + 1` and `2 * n + 2`.
+constexpr auto fill_eytzinger_positions(std::size_t * const positions, std::size_t const size, std::size_t const slot, std::size_t & next) -> void {
+	if (slot >= size) {
+		return;
+	}
+	::containers::fill_eytzinger_positions(positions, size, 2U * slot + 1U, next);
+	positions[slot] = next;
+	++next;
+	::containers::fill_eytzinger_positions(positions, size, 2U * slot + 2U, next);
+}
+
+// While comparing against one slot, the search loads the slots this many
+// levels below it, which are next to each other. With four-byte keys that is
+// one cache line for every four levels searched.
+constexpr auto prefetch_levels = 4U;
+
+// A sorted map for data that is built once and then searched many times.
+// `flat_map` finds keys with a binary search, which reads from a different
+// cache line at every step after the first few. This map keeps a copy of the
+// keys in Eytzinger order, where the slots checked in the first steps of every
+// search are all next to each other at the front, and the next slots a search
+// can go to are next to each other and can be loaded ahead of time.
+//
+// The elements are also stored in sorted order, which is what iteration sees.
+// Each slot of the search layout holds the position of its element in that
+// order. Keys must be copyable.
+export template<typename Key, typename Mapped, typename ExtractKey = to_radix_sort_key_t>
+class eytzinger_map {
+public:
+	using key_type = Key;
+	using mapped_type = Mapped;
+	using value_type = map_value_type<Key, Mapped>;
+
+private:
+	using elements_t = containers::vector<value_type>;
+	using keys_t = containers::vector<Key>;
+	using positions_t = containers::vector<std::size_t>;
+public:
+	using const_iterator = iterator_t<elements_t const &>;
+
+	constexpr auto extract_key() const {
+		return m_extract_key;
+	}
+	constexpr auto compare() const {
+		return ::containers::extract_key_to_less(m_extract_key);
+	}
+
+	eytzinger_map() = default;
+
+	template<range Source> requires(!std::same_as<std::remove_cvref_t<Source>, eytzinger_map>)
+	constexpr explicit eytzinger_map(Source && source, ExtractKey extract_key_ = ExtractKey()):
+		m_elements(OPERATORS_FORWARD(source)),
+		m_extract_key(std::move(extract_key_))
+	{
+		::containers::unique_ska_sort(m_elements, element_key());
+		build_search_layout();
+	}
+	template<range Source>
+	constexpr eytzinger_map(assume_sorted_unique_t, Source && source, ExtractKey extract_key_ = ExtractKey()):
+		m_elements(OPERATORS_FORWARD(source)),
+		m_extract_key(std::move(extract_key_))
+	{
+		BOUNDED_ASSERT(::containers::is_sorted(m_elements, ::containers::extract_key_to_less(element_key())));
+		build_search_layout();
+	}
+	template<std::size_t init_size>
+	constexpr eytzinger_map(c_array<value_type, init_size> && source, ExtractKey extract_key_ = ExtractKey()):
+		m_elements(std::move(source)),
+		m_extract_key(std::move(extract_key_))
+	{
+		::containers::unique_ska_sort(m_elements, element_key());
+		build_search_layout();
+	}
+
+	constexpr auto begin() const -> const_iterator {
+		return containers::begin(m_elements);
+	}
+	constexpr auto size() const {
+		return containers::size(m_elements);
+	}
+
+	constexpr auto find(auto const & key_) const -> const_iterator {
+		// The extracted key can depend on the type, for instance the radix key
+		// of a bounded integer, so compare only `key_type`
+		key_type const & key = key_;
+		auto const size_ = static_cast<std::size_t>(containers::size(m_keys));
+		auto const keys = containers::data(m_keys);
+		auto const less = compare();
+		auto slot = std::size_t(0);
+		while (slot < size_) {
+			if !consteval {
+				auto const descendant = (slot + 1U) * (1U << prefetch_levels) - 1U;
+				if (descendant < size_) {
+					__builtin_prefetch(keys + descendant);
+				}
+			}
+			slot = 2U * slot + 1U + static_cast<std::size_t>(less(keys[slot], key));
+		}
+		// `slot` is now past a leaf. In the 1-based numbering of the slots,
+		// each step right appended a one bit and each step left appended a
+		// zero bit. The lower bound is where the search last went left, so
+		// remove the trailing right steps and then that left step.
+		auto const one_based = (slot + 1U) >> (std::countr_one(slot + 1U) + 1);
+		if (one_based == 0U) {
+			return containers::end(*this);
+		}
+		auto const found = one_based - 1U;
+		if (less(key, keys[found])) {
+			return containers::end(*this);
+		}
+		return begin() + ::bounded::assume_in_range<iter_difference_t<const_iterator>>(containers::data(m_positions)[found]);
+	}
+
+	friend constexpr auto operator==(eytzinger_map const & lhs, eytzinger_map const & rhs) -> bool {
+		return lhs.m_elements == rhs.m_elements;
+	}
+
+private:
+	constexpr auto element_key() const {
+		return [&](value_type const & value) -> decltype(auto) {
+			return m_extract_key(value.key);
+		};
+	}
+
+	constexpr auto build_search_layout() -> void {
+		auto const size_ = static_cast<std::size_t>(containers::size(m_elements));
+		m_positions = positions_t(containers::repeat_n(
+			::bounded::assume_in_range<range_size_t<positions_t>>(size_),
+			std::size_t(0)
+		));
+		auto next = std::size_t(0);
+		::containers::fill_eytzinger_positions(containers::data(m_positions), size_, 0U, next);
+		m_keys.reserve(::bounded::assume_in_range<range_size_t<keys_t>>(size_));
+		auto const elements = containers::data(m_elements);
+		for (auto const position : m_positions) {
+			::containers::push_back(m_keys, elements[position].key);
+		}
+	}
+
+	elements_t m_elements;
+	keys_t m_keys;
+	positions_t m_positions;
+	[[no_unique_address]] ExtractKey m_extract_key;
+};
+
+} // namespace containers
+
+using namespace bounded::literal;
+
+using map_type = containers::eytzinger_map<int, int>;
+using value_type = containers::map_value_type<int, int>;
+
+static_assert(containers::associative_range<map_type>);
+static_assert(containers::associative_range<map_type const &>);
+
+static_assert(containers::equal(
+	map_type(containers::array<value_type, 4_bi>({{3, 30}, {1, 10}, {2, 20}, {1, 10}})),
+	containers::array<value_type, 3_bi>({{1, 10}, {2, 20}, {3, 30}})
+));
+
+// Every size up to a few complete trees, so that every shape of the last level
+// is covered
+constexpr auto test_size(int const size) -> bool {
+	auto source = containers::vector<value_type>();
+	for (auto key = size - 1; key >= 0; --key) {
+		containers::push_back(source, value_type{key * 2, key});
+	}
+	auto const map = map_type(source);
+	for (auto key = -1; key <= size * 2; ++key) {
+		auto const it = map.find(key);
+		if (key % 2 == 0 and key / 2 < size and key >= 0) {
+			BOUNDED_ASSERT(it != containers::end(map));
+			BOUNDED_ASSERT(it->key == key and it->mapped == key / 2);
+		} else {
+			BOUNDED_ASSERT(it == containers::end(map));
+		}
+	}
+	return true;
+}
+
+static_assert([] {
+	for (auto size = 0; size != 34; ++size) {
+		test_size(size);
+	}
+	return true;
+}());
+
+using offset_key = bounded::integer<1000, 1255>;
+using offset_map_type = containers::eytzinger_map<offset_key, int>;
+
+static_assert([] {
+	auto source = containers::vector<containers::map_value_type<offset_key, int>>();
+	for (auto key = 1000; key <= 1255; key += 5) {
+		containers::push_back(source, containers::map_value_type<offset_key, int>{bounded::assume_in_range<offset_key>(key), key});
+	}
+	auto const map = offset_map_type(source);
+	BOUNDED_ASSERT(*containers::lookup(map, 1000_bi) == 1000);
+	BOUNDED_ASSERT(*containers::lookup(map, 1100_bi) == 1100);
+	BOUNDED_ASSERT(*containers::lookup(map, 1255_bi) == 1255);
+	BOUNDED_ASSERT(containers::lookup(map, 1101_bi) == nullptr);
+	return map.find(1254_bi) == containers::end(map);
+}());
+
+static_assert([] {
+	auto const map = map_type(containers::assume_sorted_unique, containers::array<value_type, 3_bi>({{1, 10}, {5, 50}, {9, 90}}));
+	return *containers::lookup(map, 5) == 50 and containers::lookup(map, 4) == nullptr;
+}());
@@ -12,6 +12,7 @@ module;
 export module containers.flat_map;
 
 import containers.algorithms.sort.is_sorted;
+import containers.algorithms.sort.key_cached_sort;
 import containers.algorithms.sort.ska_sort;
 import containers.algorithms.sort.to_radix_sort_key;
 
@@ -19,9 +20,12 @@ import containers.algorithms.advance;
 import containers.algorithms.binary_search;
 import containers.algorithms.compare;
 import containers.algorithms.erase;
+import containers.algorithms.find;
+import containers.algorithms.interpolation_search;
 import containers.algorithms.keyed_binary_search;
 import containers.algorithms.unique;
 import containers.append;
+import containers.array;
 import containers.associative_container;
 import containers.begin_end;
 import containers.c_array;
@@ -32,7 +36,9 @@ import containers.extract_key_to_less;
 import containers.initializer_range;
 import containers.insert;
 import containers.is_range;
+import containers.iter_difference_t;
 import containers.iterator_t;
+import containers.lazy_push_back;
 import containers.legacy_iterator;
 import containers.lookup;
 import containers.map_tags;
@@ -42,6 +48,7 @@ import containers.mutable_iterator;
 import containers.push_back;
 import containers.range_value_t;
 import containers.range_view;
+import containers.reservable;
 import containers.size;
 import containers.static_vector;
 import containers.test_associative_container;
@@ -72,6 +79,9 @@ private:
 	ExtractKey m_extract;
 };
 
+template<typename T, typename ExtractKey>
+constexpr auto is_expensive_key_extractor<extract_map_key<T, ExtractKey>> = is_expensive_key_extractor<ExtractKey>;
+
 
 template<typename ExtractKey, typename T>
 concept extract_key_function = requires(ExtractKey const & extract_key, T const & value) {
@@ -282,7 +292,112 @@ protected:
 };
 
 
-export template<typename Container, extract_key_function<typename range_value_t<Container>::key_type> ExtractKey = to_radix_sort_key_t>
+constexpr auto iterator_at_offset(auto const first, std::ptrdiff_t const offset) {
+	return first + ::bounded::assume_in_range<iter_difference_t<decltype(first)>>(offset);
+}
+
+// Finds the lower bound by checking 1, 2, 4, 8... elements ahead and then
+// binary searching the last gap. This takes time logarithmic in how far away
+// the result is rather than in the size of the range.
+constexpr auto gallop_lower_bound(auto const first, auto const last, auto const & key, auto const & compare) {
+	auto const size = static_cast<std::ptrdiff_t>(last - first);
+	auto low = std::ptrdiff_t(0);
+	auto high = std::ptrdiff_t(0);
+	while (high < size and compare(*::containers::iterator_at_offset(first, high), key)) {
+		low = high + 1;
+		high = 2 * high + 1;
+	}
+	return containers::lower_bound(
+		range_view(::containers::iterator_at_offset(first, low), ::containers::iterator_at_offset(first, std::min(high, size))),
+		key,
+		compare
+	);
+}
+
+// The number of binary searches done at the same time for keys that are not
+// sorted. Each step loads one element for every search before it compares any
+// of them, so the searches wait for memory together instead of one at a time.
+constexpr auto interleaved_searches = 16;
+
+constexpr auto find_batch_impl(auto & map, range auto const & keys, auto out) {
+	auto const compare = map.compare();
+	auto const first = containers::begin(map);
+	auto const last = containers::end(map);
+	auto const found_or_end = [&](auto const it, auto const & key) {
+		return (it == last or compare(key, get_key(*it))) ? last : it;
+	};
+	if (::containers::is_sorted(keys, compare)) {
+		auto position = first;
+		for (auto const & key : keys) {
+			position = ::containers::gallop_lower_bound(position, last, key, compare);
+			*out = found_or_end(position, key);
+			++out;
+		}
+		return out;
+	}
+
+	auto const size = static_cast<std::ptrdiff_t>(last - first);
+	auto const keys_last = containers::end(keys);
+	auto bases = std::array<std::ptrdiff_t, interleaved_searches>();
+	for (auto batch_first = containers::begin(keys); batch_first != keys_last; ) {
+		auto count = 0;
+		auto batch_last = batch_first;
+		for (; count != interleaved_searches and batch_last != keys_last; ++count, ++batch_last) {
+			bases[static_cast<std::size_t>(count)] = 0;
+		}
+		// Every search is over the same number of elements, so they all take
+		// the same number of steps
+		for (auto length = size; length > 1; ) {
+			auto const half = length / 2;
+			if !consteval {
+				for (auto index = 0; index != count; ++index) {
+					__builtin_prefetch(std::addressof(*::containers::iterator_at_offset(first, bases[static_cast<std::size_t>(index)] + half - 1)));
+				}
+			}
+			auto key = batch_first;
+			for (auto index = 0; index != count; ++index, ++key) {
+				auto & base = bases[static_cast<std::size_t>(index)];
+				base += compare(*::containers::iterator_at_offset(first, base + half - 1), *key) ? half : 0;
+			}
+			length -= half;
+		}
+		auto key = batch_first;
+		for (auto index = 0; index != count; ++index, ++key) {
+			auto const base = bases[static_cast<std::size_t>(index)];
+			auto const position = size == 0 ?
+				last :
+				::containers::iterator_at_offset(first, compare(*::containers::iterator_at_offset(first, base), *key) ? base + 1 : base);
+			*out = found_or_end(position, *key);
+			++out;
+		}
+		batch_first = batch_last;
+	}
+	return out;
+}
+
+// How `basic_flat_map::find` searches, unless told otherwise
+export struct binary_search_policy {
+	static constexpr auto lower_bound(auto && map, auto const & key) {
+		return ::containers::keyed_lower_bound(OPERATORS_FORWARD(map), key);
+	}
+};
+
+// For keys that are numbers spread about evenly, such as timestamps. A search
+// guesses where the key is from the keys at the ends of the range, which
+// takes a few reads instead of log2(n). After a few guesses it switches to a
+// binary search, so skewed keys cost only a few extra reads.
+export struct interpolation_search_policy {
+	static constexpr auto lower_bound(auto && map, auto const & key) {
+		auto const compare = map.compare();
+		return ::containers::interpolation_lower_bound(OPERATORS_FORWARD(map), key, compare, get_key);
+	}
+};
+
+export template<
+	typename Container,
+	extract_key_function<typename range_value_t<Container>::key_type> ExtractKey = to_radix_sort_key_t,
+	typename SearchPolicy = binary_search_policy
+>
 class basic_flat_map : private flat_map_base<Container, ExtractKey, false> {
 private:
 	using base = flat_map_base<Container, ExtractKey, false>;
@@ -308,14 +423,25 @@ public:
 	using base::erase_if;
 
 	constexpr auto find(auto const & key) const {
-		auto const it = containers::keyed_lower_bound(*this, key);
+		auto const it = SearchPolicy::lower_bound(*this, key);
 		return (it == ::containers::end(*this) or compare()(key, get_key(*it))) ? ::containers::end(*this) : it;
 	}
 	constexpr auto find(auto const & key) {
-		auto const it = containers::keyed_lower_bound(*this, key);
+		auto const it = SearchPolicy::lower_bound(*this, key);
 		return (it == ::containers::end(*this) or compare()(key, get_key(*it))) ? ::containers::end(*this) : it;
 	}
 
+	// Writes `find(key)` to `out` for each of `keys`, in the same order as
+	// `keys`, and returns `out` after the last one written. Sorted keys are
+	// found in one pass through the map. Otherwise, the keys are found with
+	// several binary searches at a time.
+	constexpr auto find_batch(range auto const & keys, auto out) const {
+		return ::containers::find_batch_impl(*this, keys, std::move(out));
+	}
+	constexpr auto find_batch(range auto const & keys, auto out) {
+		return ::containers::find_batch_impl(*this, keys, std::move(out));
+	}
+
 	// `Other` is required to be a unique range of elements
 	template<range Other>
 	constexpr auto upsert(Other && other, auto && update) -> void {
@@ -334,6 +460,49 @@ public:
 		auto const midpoint = begin() + original_size;
 		::containers::merge_sorted_and_unsorted<false>(this->m_container, midpoint, extract_key());
 	}
+
+	// `Other` is required to be sorted by this map's key and have no
+	// duplicates. This merges the two in a single pass into a new container
+	// instead of searching for each element of `other`, so it takes linear
+	// time but temporarily needs room for both.
+	template<range Other>
+	constexpr auto upsert(assume_sorted_unique_t, Other && other, auto && update) -> void {
+		auto const less = compare();
+		auto const key_less = [&](auto const & lhs, auto const & rhs) {
+			return less(get_key(lhs), get_key(rhs));
+		};
+		BOUNDED_ASSERT(::containers::is_sorted(other, key_less));
+		auto result = Container();
+		if constexpr (reservable<Container> and sized_range<Other>) {
+			result.reserve(::bounded::assume_in_range<range_size_t<Container>>(size() + containers::size(other)));
+		}
+		auto it = containers::begin(this->m_container);
+		auto const last = containers::end(this->m_container);
+		auto other_it = containers::begin(OPERATORS_FORWARD(other));
+		auto const other_last = containers::end(OPERATORS_FORWARD(other));
+		while (it != last and other_it != other_last) {
+			auto && value = dereference<Other>(other_it);
+			if (key_less(*it, value)) {
+				::containers::push_back(result, std::move(*it));
+				++it;
+			} else if (key_less(value, *it)) {
+				::containers::push_back(result, OPERATORS_FORWARD(value));
+				++other_it;
+			} else {
+				update(get_mapped(*it), ::containers::get_mapped(OPERATORS_FORWARD(value)));
+				::containers::push_back(result, std::move(*it));
+				++it;
+				++other_it;
+			}
+		}
+		for (; it != last; ++it) {
+			::containers::push_back(result, std::move(*it));
+		}
+		for (; other_it != other_last; ++other_it) {
+			::containers::push_back(result, dereference<Other>(other_it));
+		}
+		this->m_container = std::move(result);
+	}
 };
 
 template<typename Range>
@@ -393,6 +562,143 @@ basic_flat_multimap(assume_sorted_unique_t, Range &&) -> basic_flat_multimap<std
 template<typename Range, typename ExtractKey>
 basic_flat_multimap(assume_sorted_unique_t, Range &&, ExtractKey) -> basic_flat_multimap<std::remove_const_t<Range>, ExtractKey>;
 
+// The buffer is merged once it has more than this many elements or about the
+// square root of the number of sorted elements, whichever is larger. An insert
+// then costs a scan of the buffer plus its share of a merge of the whole map,
+// both of which are proportional to the square root of the size of the map.
+constexpr auto minimum_buffer_size = std::size_t(16);
+
+// A map for building up one element at a time while also looking up elements.
+// `basic_flat_map::lazy_insert` shifts every element after the new one, so
+// adding elements one at a time takes quadratic time. This map instead adds
+// new elements to an unsorted buffer at the end of the container, and merges
+// the buffer into the sorted elements with a single sort and merge once it is
+// full. Lookups binary search the sorted elements and then check each element
+// in the buffer.
+//
+// Iteration visits the sorted elements and then the buffer, so elements are
+// only in order after a call to `flush`.
+export template<typename Container, extract_key_function<typename range_value_t<Container>::key_type> ExtractKey = to_radix_sort_key_t>
+class basic_buffered_flat_map {
+public:
+	using value_type = range_value_t<Container>;
+	using key_type = typename value_type::key_type;
+	using mapped_type = typename value_type::mapped_type;
+
+	constexpr auto extract_key() const {
+		return extract_map_key<value_type, ExtractKey>(m_extract_key);
+	}
+	constexpr auto compare() const {
+		return ::containers::extract_key_to_less(extract_key());
+	}
+
+	basic_buffered_flat_map() = default;
+	constexpr explicit basic_buffered_flat_map(ExtractKey extract_key_):
+		m_extract_key(std::move(extract_key_))
+	{
+	}
+
+	constexpr explicit basic_buffered_flat_map(constructor_initializer_range<basic_buffered_flat_map> auto && source, ExtractKey extract_key_ = ExtractKey()):
+		m_container(OPERATORS_FORWARD(source)),
+		m_extract_key(std::move(extract_key_))
+	{
+		unique_ska_sort(m_container, extract_key());
+		m_sorted_size = containers::size(m_container);
+	}
+	template<std::size_t init_size>
+	constexpr basic_buffered_flat_map(c_array<value_type, init_size> && source, ExtractKey extract_key_ = ExtractKey()):
+		m_container(std::move(source)),
+		m_extract_key(std::move(extract_key_))
+	{
+		unique_ska_sort(m_container, extract_key());
+		m_sorted_size = containers::size(m_container);
+	}
+
+	constexpr auto begin() const {
+		return ::containers::begin(m_container);
+	}
+	constexpr auto begin() {
+		return ::containers::begin(m_container);
+	}
+	constexpr auto size() const {
+		return ::containers::size(m_container);
+	}
+
+	constexpr auto capacity() const {
+		return m_container.capacity();
+	}
+	constexpr auto reserve(range_size_t<Container> const new_capacity) {
+		return m_container.reserve(new_capacity);
+	}
+
+	constexpr auto find(auto const & key) const {
+		return find_impl(*this, key);
+	}
+	constexpr auto find(auto const & key) {
+		return find_impl(*this, key);
+	}
+
+	template<typename Key = key_type>
+	constexpr auto lazy_insert(Key && key, bounded::construct_function_for<mapped_type> auto && mapped) {
+		auto const existing = find(key);
+		if (existing != containers::end(m_container)) {
+			return inserted_t{existing, false};
+		}
+		if (static_cast<std::size_t>(containers::size(m_container) - m_sorted_size) >= maximum_buffer_size()) {
+			flush();
+		}
+		::containers::lazy_push_back(m_container, [&] {
+			return value_type{OPERATORS_FORWARD(key), OPERATORS_FORWARD(mapped)()};
+		});
+		return inserted_t{containers::prev(containers::end(m_container)), true};
+	}
+
+	constexpr auto insert(range auto && init) -> void {
+		::containers::append(m_container, OPERATORS_FORWARD(init));
+		flush();
+	}
+
+	// Merges the buffer into the sorted elements
+	constexpr auto flush() -> void {
+		auto const midpoint = containers::begin(m_container) + m_sorted_size;
+		::containers::merge_sorted_and_unsorted<false>(m_container, midpoint, extract_key());
+		m_sorted_size = containers::size(m_container);
+	}
+
+	constexpr auto erase_if(auto const predicate) {
+		flush();
+		auto const result = containers::erase_if(m_container, predicate);
+		m_sorted_size = containers::size(m_container);
+		return result;
+	}
+
+private:
+	constexpr auto maximum_buffer_size() const -> std::size_t {
+		auto const sorted_size = static_cast<std::size_t>(m_sorted_size);
+		return std::max(minimum_buffer_size, std::size_t(1) << (std::bit_width(sorted_size) / 2));
+	}
+
+	static constexpr auto find_impl(auto & map, auto const & key) {
+		auto const compare = map.compare();
+		auto const first = containers::begin(map.m_container);
+		auto const sorted_last = first + map.m_sorted_size;
+		auto const it = containers::lower_bound(range_view(first, sorted_last), key, compare);
+		if (it != sorted_last and !compare(key, get_key(*it))) {
+			return it;
+		}
+		return containers::find_if(
+			range_view(sorted_last, containers::end(map.m_container)),
+			[&](value_type const & value) {
+				return !compare(key, get_key(value)) and !compare(get_key(value), key);
+			}
+		);
+	}
+
+	Container m_container;
+	range_size_t<Container> m_sorted_size = bounded::constant<0>;
+	[[no_unique_address]] ExtractKey m_extract_key;
+};
+
 template<typename Key>
 constexpr auto maximum_map_size = maximum_array_size<Key>;
 
@@ -405,6 +711,9 @@ using flat_map = basic_flat_map<vector<map_value_type<Key, Mapped>, maximum_map_
 export template<typename Key, typename Mapped, array_size_type<map_value_type<Key, Mapped>> capacity, typename... MaybeExtractKey>
 using static_flat_map = basic_flat_map<static_vector<map_value_type<Key, Mapped>, capacity>, MaybeExtractKey...>;
 
+export template<typename Key, typename Mapped, typename... MaybeExtractKey>
+using buffered_flat_map = basic_buffered_flat_map<vector<map_value_type<Key, Mapped>, maximum_map_size<Key>>, MaybeExtractKey...>;
+
 export template<typename Key, typename Mapped, typename... MaybeExtractKey>
 using flat_multimap = basic_flat_multimap<vector<map_value_type<Key, Mapped>>, MaybeExtractKey...>;
 
@@ -524,6 +833,112 @@ constexpr auto test_upsert() -> bool {
 }
 static_assert(test_upsert<non_copyable_map>());
 
+template<typename Container>
+constexpr auto test_upsert_sorted() -> bool {
+	auto container = Container({{1, 3}, {3, 5}, {5, 7}});
+	container.upsert(containers::assume_sorted_unique, Container({{0, 1}, {3, 1}, {4, 2}, {6, 3}}), add);
+	BOUNDED_ASSERT(container == Container({{0, 1}, {1, 3}, {3, 6}, {4, 2}, {5, 7}, {6, 3}}));
+	container.upsert(containers::assume_sorted_unique, Container(), add);
+	BOUNDED_ASSERT(container == Container({{0, 1}, {1, 3}, {3, 6}, {4, 2}, {5, 7}, {6, 3}}));
+	auto empty = Container();
+	empty.upsert(containers::assume_sorted_unique, Container({{2, 2}}), add);
+	BOUNDED_ASSERT(empty == Container({{2, 2}}));
+	return true;
+}
+static_assert(test_upsert_sorted<non_copyable_map>());
+
+// Keys 0, 2, 4... 98, so odd keys are missing
+constexpr auto make_even_map() {
+	auto map = containers::flat_map<int, int>();
+	for (auto key = 0; key != 100; key += 2) {
+		map.lazy_insert(key, bounded::value_to_function(key + 1));
+	}
+	return map;
+}
+
+constexpr auto test_find_batch(auto const & map, auto const & keys) -> bool {
+	using iterator = decltype(containers::begin(map));
+	auto results = containers::array<iterator, bounded::constant<32>>();
+	auto const last = map.find_batch(keys, containers::begin(results));
+	BOUNDED_ASSERT(last - containers::begin(results) == containers::size(keys));
+	auto it = containers::begin(results);
+	for (auto const key : keys) {
+		BOUNDED_ASSERT(*it == map.find(key));
+		++it;
+	}
+	return true;
+}
+
+static_assert(test_find_batch(make_even_map(), containers::array({-1, 0, 0, 1, 2, 3, 50, 51, 98, 99, 100})));
+static_assert(test_find_batch(make_even_map(), containers::array({99, 0, 51, 50, -1, 98, 2, 7, 64, 100, 3, 12, 12, 40, 41, 76, 1, 88, 90, 33, 6})));
+static_assert(test_find_batch(containers::flat_map<int, int>(), containers::array({3, 1, 2})));
+static_assert(test_find_batch(containers::flat_map<int, int>({{5, 1}}), containers::array({6, 5, 4})));
+static_assert([] {
+	auto map = make_even_map();
+	auto results = containers::array<containers::iterator_t<decltype(map) &>, bounded::constant<2>>();
+	map.find_batch(containers::array({4, 3}), containers::begin(results));
+	auto const found = containers::begin(results);
+	containers::get_mapped(**found) = 0;
+	return *containers::lookup(map, 4) == 0 and *containers::next(found) == containers::end(map);
+}());
+
+static_assert([] {
+	using key_type = bounded::integer<0, 100'000>;
+	using value_type = containers::map_value_type<key_type, int>;
+	using map_type = containers::basic_flat_map<
+		containers::vector<value_type>,
+		containers::to_radix_sort_key_t,
+		containers::interpolation_search_policy
+	>;
+	auto map = map_type();
+	// Evenly spread keys followed by a few far apart
+	for (auto n = 0; n != 200; ++n) {
+		map.lazy_insert(bounded::assume_in_range<key_type>(n * 10), bounded::value_to_function(n));
+	}
+	for (auto const key : containers::array({5'000, 50'000, 99'999})) {
+		map.lazy_insert(bounded::assume_in_range<key_type>(key), bounded::value_to_function(-key));
+	}
+	for (auto key = 0; key != 2'100; ++key) {
+		auto const found = containers::lookup(map, bounded::assume_in_range<key_type>(key));
+		BOUNDED_ASSERT(key % 10 == 0 and key < 2'000 ? found and *found == key / 10 : !found);
+	}
+	BOUNDED_ASSERT(*containers::lookup(map, bounded::assume_in_range<key_type>(50'000)) == -50'000);
+	BOUNDED_ASSERT(*containers::lookup(map, bounded::assume_in_range<key_type>(99'999)) == -99'999);
+	BOUNDED_ASSERT(!containers::lookup(map, bounded::assume_in_range<key_type>(99'998)));
+	return true;
+}());
+
+static_assert([] {
+	auto map = containers::buffered_flat_map<int, int>();
+	// Descending keys are the worst case for inserting into a sorted array
+	for (auto key = 199; key >= 0; --key) {
+		auto const inserted = map.lazy_insert(key, bounded::value_to_function(key * 2));
+		BOUNDED_ASSERT(inserted.inserted);
+		BOUNDED_ASSERT(containers::get_key(*inserted.iterator) == key);
+		for (auto previous = key; previous < 200; previous += 37) {
+			BOUNDED_ASSERT(*containers::lookup(map, previous) == previous * 2);
+		}
+		BOUNDED_ASSERT(!containers::lookup(map, key - 1));
+	}
+	BOUNDED_ASSERT(!map.lazy_insert(0, bounded::value_to_function(1)).inserted);
+	BOUNDED_ASSERT(!map.lazy_insert(150, bounded::value_to_function(1)).inserted);
+	BOUNDED_ASSERT(containers::size(map) == bounded::constant<200>);
+	map.flush();
+	auto expected = containers::flat_map<int, int>();
+	for (auto key = 0; key != 200; ++key) {
+		expected.lazy_insert(key, bounded::value_to_function(key * 2));
+	}
+	return containers::equal(map, expected);
+}());
+
+static_assert([] {
+	auto map = containers::buffered_flat_map<int, int>({{3, 3}, {1, 1}});
+	map.lazy_insert(2, bounded::value_to_function(2));
+	map.insert(containers::array<containers::map_value_type<int, int>, bounded::constant<2>>({{0, 0}, {4, 4}}));
+	BOUNDED_ASSERT(map.erase_if([](auto const & value) { return value.key == 3; }) == bounded::constant<1>);
+	return containers::equal(map, containers::flat_map<int, int>({{0, 0}, {1, 1}, {2, 2}, {4, 4}}));
+}());
+
 template<typename Key>
 constexpr auto max_map_size = numeric_traits::max_value<containers::range_size_t<containers::flat_map<Key, int>>>;
 
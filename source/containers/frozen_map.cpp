@@ -0,0 +1,366 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+#include <operators/forward.hpp>
+
+export module containers.frozen_map;
+
+import containers.array;
+import containers.associative_container;
+import containers.begin_end;
+import containers.c_array;
+import containers.data;
+import containers.lookup;
+import containers.map_value_type;
+
+import bounded;
+import numeric_traits;
+import std_module;
+
+namespace containers {
+
+// The finalizer of splitmix64. Every bit of the input affects every bit of the
+// output.
+constexpr auto mix(std::uint64_t value) -> std::uint64_t {
+	value = (value ^ (value >> 30U)) * 0xBF58'476D'1CE4'E5B9U;
+	value = (value ^ (value >> 27U)) * 0x94D0'49BB'1331'11EBU;
+	return value ^ (value >> 31U);
+}
+
+constexpr auto seed_offset(std::uint64_t const seed) -> std::uint64_t {
+	return seed * 0x9E37'79B9'7F4A'7C15U;
+}
+
+// Keys can be integers, enums, or anything that converts to
+// `std::string_view`. A key and anything it is compared with must hash the
+// same, so all integers hash their value and all strings hash their
+// characters.
+constexpr auto frozen_hash(auto const & key, std::uint64_t const seed) -> std::uint64_t {
+	using key_t = std::remove_cvref_t<decltype(key)>;
+	if constexpr (bounded::bounded_integer<key_t>) {
+		return ::containers::frozen_hash(key.value(), seed);
+	} else if constexpr (std::is_enum_v<key_t>) {
+		return ::containers::frozen_hash(std::to_underlying(key), seed);
+	} else if constexpr (std::integral<key_t>) {
+		return ::containers::mix(static_cast<std::uint64_t>(key) + ::containers::seed_offset(seed));
+	} else {
+		// FNV-1a
+		auto result = 0xCBF2'9CE4'8422'2325U ^ seed;
+		for (auto const c : std::string_view(key)) {
+			result = (result ^ static_cast<std::uint8_t>(c)) * 0x0000'0100'0000'01B3U;
+		}
+		return ::containers::mix(result);
+	}
+}
+
+// A minimal perfect hash of `size` keys, which sends each of them to a
+// different slot in `[0, size)`, using hash and displace. The hash of a key
+// chooses a bucket, and each bucket has a seed that chooses the slots of its
+// keys. A negative seed is the slot itself, for a bucket with one key.
+template<std::size_t size>
+struct perfect_hash {
+	constexpr auto hash(auto const & key) const -> std::uint64_t {
+		return ::containers::frozen_hash(key, key_seed);
+	}
+	constexpr auto slot(std::uint64_t const key_hash) const -> std::size_t {
+		auto const seed = containers::data(seeds)[key_hash % size];
+		return seed < 0 ?
+			static_cast<std::size_t>(-(seed + 1)) :
+			static_cast<std::size_t>(::containers::mix(key_hash + ::containers::seed_offset(static_cast<std::uint64_t>(seed))) % size);
+	}
+
+	std::uint64_t key_seed;
+	containers::array<std::int32_t, bounded::constant<size>> seeds;
+};
+
+// How many seeds to try for one bucket before starting over with a different
+// key seed
+constexpr auto maximum_bucket_seed = std::int32_t(100'000);
+
+// Fills in `result.seeds` and `slot_of_key`. Returns `false` if there is no
+// perfect hash with this key seed. Buckets with more keys are placed first,
+// while most slots are still free.
+template<std::size_t size>
+constexpr auto try_build_perfect_hash(perfect_hash<size> & result, std::array<std::uint64_t, size> const & hashes, std::array<std::size_t, size> & slot_of_key) -> bool {
+	auto sorted_hashes = hashes;
+	std::ranges::sort(sorted_hashes);
+	if (std::ranges::adjacent_find(sorted_hashes) != sorted_hashes.end()) {
+		return false;
+	}
+
+	auto bucket_sizes = std::array<std::size_t, size>();
+	for (auto const key_hash : hashes) {
+		++bucket_sizes[key_hash % size];
+	}
+	// The keys of each bucket are next to each other, with the largest
+	// buckets first
+	auto order = std::array<std::size_t, size>();
+	std::iota(order.begin(), order.end(), std::size_t(0));
+	std::ranges::sort(order, [&](std::size_t const lhs, std::size_t const rhs) {
+		auto const lhs_bucket = hashes[lhs] % size;
+		auto const rhs_bucket = hashes[rhs] % size;
+		return
+			bucket_sizes[lhs_bucket] > bucket_sizes[rhs_bucket] or
+			(bucket_sizes[lhs_bucket] == bucket_sizes[rhs_bucket] and lhs_bucket < rhs_bucket);
+	});
+
+	auto occupied = std::array<bool, size>();
+	auto seeds = containers::data(result.seeds);
+	auto first = order.begin();
+	while (first != order.end() and bucket_sizes[hashes[*first] % size] > 1U) {
+		auto const bucket = hashes[*first] % size;
+		auto const last = first + static_cast<std::ptrdiff_t>(bucket_sizes[bucket]);
+		auto seed = std::int32_t(0);
+		while (true) {
+			if (seed == maximum_bucket_seed) {
+				return false;
+			}
+			seeds[bucket] = seed;
+			auto const fits = [&] {
+				for (auto it = first; it != last; ++it) {
+					auto const slot = result.slot(hashes[*it]);
+					if (occupied[slot]) {
+						return false;
+					}
+					for (auto previous = first; previous != it; ++previous) {
+						if (slot_of_key[*previous] == slot) {
+							return false;
+						}
+					}
+					slot_of_key[*it] = slot;
+				}
+				return true;
+			}();
+			if (fits) {
+				break;
+			}
+			++seed;
+		}
+		for (auto it = first; it != last; ++it) {
+			occupied[slot_of_key[*it]] = true;
+		}
+		first = last;
+	}
+
+	auto free_slot = std::size_t(0);
+	for (; first != order.end(); ++first) {
+		while (occupied[free_slot]) {
+			++free_slot;
+		}
+		occupied[free_slot] = true;
+		seeds[hashes[*first] % size] = -static_cast<std::int32_t>(free_slot) - 1;
+		slot_of_key[*first] = free_slot;
+	}
+	return true;
+}
+
+// Returns the slot of each key, in the order of the keys
+template<std::size_t size>
+constexpr auto build_perfect_hash(perfect_hash<size> & result, auto const key_at) -> std::array<std::size_t, size> {
+	BOUNDED_ASSERT(size <= static_cast<std::size_t>(numeric_traits::max_value<std::int32_t>));
+	for (std::size_t lhs = 0; lhs != size; ++lhs) {
+		for (std::size_t rhs = lhs + 1U; rhs != size; ++rhs) {
+			BOUNDED_ASSERT(!(key_at(lhs) == key_at(rhs)));
+		}
+	}
+	auto slot_of_key = std::array<std::size_t, size>();
+	for (result.key_seed = 0; ; ++result.key_seed) {
+		auto hashes = std::array<std::uint64_t, size>();
+		for (std::size_t index = 0; index != size; ++index) {
+			hashes[index] = result.hash(key_at(index));
+		}
+		if (::containers::try_build_perfect_hash(result, hashes, slot_of_key)) {
+			return slot_of_key;
+		}
+	}
+}
+
+// Puts `source[n]` at `slot_of_key[n]`
+template<std::size_t size, typename T>
+constexpr auto arrange_by_slot(c_array<T, size> & source, std::array<std::size_t, size> const & slot_of_key) {
+	auto key_of_slot = std::array<std::size_t, size>();
+	for (std::size_t index = 0; index != size; ++index) {
+		key_of_slot[slot_of_key[index]] = index;
+	}
+	return [&]<std::size_t... slots>(std::index_sequence<slots...>) {
+		return containers::array<T, bounded::constant<size>>{{std::move(source[key_of_slot[slots]])...}};
+	}(std::make_index_sequence<size>());
+}
+
+// A map whose elements are chosen at compile time. `make_frozen_map` computes a
+// minimal perfect hash of the keys, so `find` hashes the key once, reads one
+// seed, and compares with one element. A `frozen_map` in a `constexpr`
+// variable needs no construction or allocation at run time.
+//
+// The elements are in the order of their slots, not the order they were given
+// in.
+export template<typename Key, typename Mapped, std::size_t size_>
+struct frozen_map {
+	using key_type = Key;
+	using mapped_type = Mapped;
+	using value_type = map_value_type<Key, Mapped>;
+
+	constexpr auto begin() const {
+		return containers::begin(m_values);
+	}
+	static constexpr auto size() {
+		return bounded::constant<size_>;
+	}
+
+	constexpr auto find(auto const & key) const {
+		auto const slot = m_hash.slot(m_hash.hash(key));
+		auto const it = begin() + ::bounded::assume_in_range(slot, bounded::constant<0>, bounded::constant<size_ - 1>);
+		return it->key == key ? it : containers::end(*this);
+	}
+
+	friend constexpr auto operator==(frozen_map const & lhs, frozen_map const & rhs) -> bool {
+		return lhs.m_values == rhs.m_values;
+	}
+
+	// Consider these private. They must be public for `make_frozen_map` to
+	// fill them in.
+	perfect_hash<size_> m_hash;
+	containers::array<value_type, bounded::constant<size_>> m_values;
+};
+
+export template<typename Key, typename Mapped, std::size_t size>
+consteval auto make_frozen_map(c_array<map_value_type<Key, Mapped>, size> && source) -> frozen_map<Key, Mapped, size> {
+	auto hash = perfect_hash<size>();
+	auto const slot_of_key = ::containers::build_perfect_hash(hash, [&](std::size_t const index) -> Key const & {
+		return source[index].key;
+	});
+	return frozen_map<Key, Mapped, size>{
+		hash,
+		::containers::arrange_by_slot(source, slot_of_key)
+	};
+}
+
+// A set whose keys are chosen at compile time. See `frozen_map`.
+export template<typename Key, std::size_t size_>
+struct frozen_set {
+	using key_type = Key;
+	using value_type = Key;
+
+	constexpr auto begin() const {
+		return containers::begin(m_keys);
+	}
+	static constexpr auto size() {
+		return bounded::constant<size_>;
+	}
+
+	constexpr auto find(auto const & key) const {
+		auto const slot = m_hash.slot(m_hash.hash(key));
+		auto const it = begin() + ::bounded::assume_in_range(slot, bounded::constant<0>, bounded::constant<size_ - 1>);
+		return *it == key ? it : containers::end(*this);
+	}
+	constexpr auto contains(auto const & key) const -> bool {
+		return find(key) != containers::end(*this);
+	}
+
+	friend constexpr auto operator==(frozen_set const & lhs, frozen_set const & rhs) -> bool {
+		return lhs.m_keys == rhs.m_keys;
+	}
+
+	// Consider these private. They must be public for `make_frozen_set` to
+	// fill them in.
+	perfect_hash<size_> m_hash;
+	containers::array<Key, bounded::constant<size_>> m_keys;
+};
+
+export template<typename Key, std::size_t size>
+consteval auto make_frozen_set(c_array<Key, size> && source) -> frozen_set<Key, size> {
+	auto hash = perfect_hash<size>();
+	auto const slot_of_key = ::containers::build_perfect_hash(hash, [&](std::size_t const index) -> Key const & {
+		return source[index];
+	});
+	return frozen_set<Key, size>{
+		hash,
+		::containers::arrange_by_slot(source, slot_of_key)
+	};
+}
+
+} // namespace containers
+
+using namespace bounded::literal;
+
+constexpr auto status_codes = containers::make_frozen_map<int, std::string_view>({
+	{200, "OK"},
+	{201, "Created"},
+	{204, "No Content"},
+	{301, "Moved Permanently"},
+	{304, "Not Modified"},
+	{400, "Bad Request"},
+	{401, "Unauthorized"},
+	{403, "Forbidden"},
+	{404, "Not Found"},
+	{500, "Internal Server Error"},
+	{503, "Service Unavailable"},
+});
+
+static_assert(containers::associative_range<decltype(status_codes)>);
+static_assert(status_codes.size() == 11_bi);
+static_assert(*containers::lookup(status_codes, 404) == "Not Found");
+static_assert(*containers::lookup(status_codes, 200) == "OK");
+static_assert(containers::lookup(status_codes, 202) == nullptr);
+static_assert(containers::lookup(status_codes, -1) == nullptr);
+
+constexpr auto keywords = containers::make_frozen_map<std::string_view, int>({
+	{"if", 0},
+	{"else", 1},
+	{"for", 2},
+	{"while", 3},
+	{"return", 4},
+	{"break", 5},
+	{"continue", 6},
+	{"switch", 7},
+	{"case", 8},
+	{"default", 9},
+});
+
+static_assert(*containers::lookup(keywords, std::string_view("while")) == 3);
+static_assert(keywords.find("return")->mapped == 4);
+static_assert(keywords.find("goto") == containers::end(keywords));
+static_assert(keywords.find("") == containers::end(keywords));
+
+// Every key is in the slot that `find` computes for it
+template<typename Map>
+constexpr auto finds_every_element(Map const & map) -> bool {
+	for (auto it = containers::begin(map); it != containers::end(map); ++it) {
+		if (map.find(it->key) != it) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(finds_every_element(status_codes));
+static_assert(finds_every_element(keywords));
+
+constexpr auto bounded_keys = containers::make_frozen_map<bounded::integer<0, 1000>, int>({
+	{0_bi, 0},
+	{10_bi, 1},
+	{20_bi, 2},
+	{999_bi, 3},
+	{1000_bi, 4},
+});
+static_assert(*containers::lookup(bounded_keys, 999_bi) == 3);
+static_assert(finds_every_element(bounded_keys));
+
+constexpr auto one_key = containers::make_frozen_map<int, int>({{5, 50}});
+static_assert(*containers::lookup(one_key, 5) == 50);
+static_assert(containers::lookup(one_key, 6) == nullptr);
+
+constexpr auto vowels = containers::make_frozen_set<char>({'a', 'e', 'i', 'o', 'u'});
+static_assert(vowels.contains('e'));
+static_assert(!vowels.contains('b'));
+static_assert(vowels.size() == 5_bi);
+
+constexpr auto commands = containers::make_frozen_set<std::string_view>({"get", "set", "delete"});
+static_assert(commands.contains("set"));
+static_assert(!commands.contains("put"));
@@ -0,0 +1,895 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+#include <operators/arrow.hpp>
+#include <operators/forward.hpp>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+export module containers.hash_map;
+
+import containers.associative_container;
+import containers.begin_end;
+import containers.c_array;
+import containers.data;
+import containers.is_range;
+import containers.lookup;
+import containers.map_tags;
+import containers.map_value_type;
+import containers.maximum_array_size;
+import containers.repeat_n;
+import containers.size;
+import containers.uninitialized_dynamic_array;
+import containers.vector;
+export import containers.common_iterator_functions;
+
+import bounded;
+import bounded.test_int;
+import std_module;
+
+namespace containers {
+
+template<typename Key>
+concept has_two_spare_representations = bounded::tombstone_traits<Key>::spare_representations >= bounded::constant<2>;
+
+// What a `hash_map` stores when its key has at least two spare
+// representations. A slot of the table that does not hold an element holds one
+// of those representations in `key`, and `mapped` is not constructed, so the
+// table needs nothing else to know which slots are full. A `hash_map_value`
+// that a user can name always holds an element.
+export template<typename Key, typename Mapped>
+struct hash_map_value {
+	using key_type = Key;
+	using mapped_type = Mapped;
+
+	constexpr hash_map_value(Key key_, Mapped mapped_):
+		key(std::move(key_)),
+		mapped(std::move(mapped_))
+	{
+	}
+
+	constexpr hash_map_value(hash_map_value const & other) requires std::is_copy_constructible_v<Key> and std::is_copy_constructible_v<Mapped>:
+		key(other.key)
+	{
+		if (other.is_full()) {
+			bounded::construct_at(mapped, [&] -> Mapped const & { return other.mapped; });
+		}
+	}
+	constexpr hash_map_value(hash_map_value && other) noexcept(std::is_nothrow_move_constructible_v<Key> and std::is_nothrow_move_constructible_v<Mapped>):
+		key(std::move(other.key))
+	{
+		if (other.is_full()) {
+			bounded::construct_at(mapped, [&] -> Mapped && { return std::move(other.mapped); });
+		}
+	}
+
+	constexpr auto operator=(hash_map_value const & other) & -> hash_map_value & requires std::is_copy_constructible_v<Key> and std::is_copy_constructible_v<Mapped> {
+		if (this != std::addressof(other)) {
+			bounded::destroy(*this);
+			bounded::construct_at(*this, [&] { return hash_map_value(other); });
+		}
+		return *this;
+	}
+	constexpr auto operator=(hash_map_value && other) & noexcept(std::is_nothrow_move_constructible_v<Key> and std::is_nothrow_move_constructible_v<Mapped>) -> hash_map_value & {
+		if (this != std::addressof(other)) {
+			bounded::destroy(*this);
+			bounded::construct_at(*this, [&] { return hash_map_value(std::move(other)); });
+		}
+		return *this;
+	}
+
+	~hash_map_value() requires std::is_trivially_destructible_v<Mapped> = default;
+	constexpr ~hash_map_value() {
+		if (is_full()) {
+			bounded::destroy(mapped);
+		}
+	}
+
+	friend constexpr auto operator==(hash_map_value const & lhs, hash_map_value const & rhs) -> bool {
+		return lhs.key == rhs.key and lhs.mapped == rhs.mapped;
+	}
+
+	[[no_unique_address]] Key key;
+	union {
+		Mapped mapped;
+	};
+
+private:
+	constexpr explicit hash_map_value(bounded::tombstone_tag, auto const make) noexcept:
+		key(make())
+	{
+	}
+
+	constexpr auto is_full() const -> bool {
+		return bounded::tombstone_traits<Key>::index(key) == bounded::constant<-1>;
+	}
+
+	friend bounded::tombstone_traits<hash_map_value>;
+	friend bounded::tombstone_traits_composer<&hash_map_value::key>;
+};
+
+// Integers are their own hash, as they are for most implementations of
+// `std::hash`, which also lets a `hash_map` be used in a constant expression.
+// `mix_hash` spreads them out.
+template<typename T>
+constexpr auto hash_key(T const & key) -> std::uint64_t {
+	if constexpr (bounded::bounded_integer<T>) {
+		return ::containers::hash_key(key.value());
+	} else if constexpr (bounded::builtin_integer<T>) {
+		return static_cast<std::uint64_t>(key);
+	} else {
+		return static_cast<std::uint64_t>(std::hash<T>()(key));
+	}
+}
+
+// Multiplying by 2^64 divided by the golden ratio moves every difference
+// between two hashes into the high bits, and the shift brings some of that back
+// down into the low bits.
+constexpr auto mix_hash(std::uint64_t const hash) -> std::uint64_t {
+	auto const product = hash * 0x9E37'79B9'7F4A'7C15U;
+	return product ^ (product >> 32U);
+}
+
+// The low seven bits of the hash are kept in the control bytes, so the rest of
+// the hash chooses the slot.
+constexpr auto probe_start(std::uint64_t const hash, std::size_t const capacity) -> std::size_t {
+	return static_cast<std::size_t>(hash >> 7U) & (capacity - 1U);
+}
+
+// The smallest capacity of `Table` that can hold `size` elements. Each table
+// is rebuilt before more of its slots are full or deleted than its
+// `max_load`, so there is always an empty slot to end a search.
+template<typename Table>
+constexpr auto table_capacity_for(std::size_t const size) -> std::size_t {
+	auto capacity = Table::minimum_capacity;
+	while (Table::max_load(capacity) < size) {
+		capacity *= 2U;
+	}
+	return capacity;
+}
+
+// Linear probing over slots that say for themselves whether they are empty,
+// deleted, or full
+template<typename Value>
+struct tombstone_table {
+	using value_type = Value;
+
+	// A search reads one slot at a time, and a search for a key that is not
+	// there reads about (1 + 1 / (1 - load)^2) / 2 slots. At 3/4 full that is
+	// about 8.
+	static constexpr auto minimum_capacity = std::size_t(8);
+	static constexpr auto max_load(std::size_t const capacity_) -> std::size_t {
+		return capacity_ - capacity_ / 4U;
+	}
+
+	tombstone_table() = default;
+	constexpr explicit tombstone_table(std::size_t const capacity_):
+		m_slots(containers::repeat_n(
+			::bounded::assume_in_range<range_size_t<slots_t>>(capacity_),
+			traits::make(empty)
+		))
+	{
+	}
+
+	constexpr auto capacity() const -> std::size_t {
+		return static_cast<std::size_t>(containers::size(m_slots));
+	}
+	constexpr auto slots() const -> Value const * {
+		return containers::data(m_slots);
+	}
+	constexpr auto slots() -> Value * {
+		return containers::data(m_slots);
+	}
+
+	constexpr auto next_full(std::size_t index) const -> std::size_t {
+		auto const capacity_ = capacity();
+		while (index != capacity_ and traits::index(slots()[index]) != bounded::constant<-1>) {
+			++index;
+		}
+		return index;
+	}
+
+	// Returns `capacity()` if there is no match
+	constexpr auto find(std::uint64_t const hash, auto const matches) const -> std::size_t {
+		auto const capacity_ = capacity();
+		if (capacity_ == 0U) {
+			return capacity_;
+		}
+		for (auto index = ::containers::probe_start(hash, capacity_); ; index = (index + 1U) & (capacity_ - 1U)) {
+			auto const & slot = slots()[index];
+			auto const marker = traits::index(slot);
+			if (marker == empty) {
+				return capacity_;
+			}
+			if (marker == bounded::constant<-1> and matches(slot)) {
+				return index;
+			}
+		}
+	}
+
+	constexpr auto insert_position(std::uint64_t const hash) const -> std::size_t {
+		auto const capacity_ = capacity();
+		auto index = ::containers::probe_start(hash, capacity_);
+		while (traits::index(slots()[index]) == bounded::constant<-1>) {
+			index = (index + 1U) & (capacity_ - 1U);
+		}
+		return index;
+	}
+
+	// Returns whether the slot was marked as deleted
+	constexpr auto construct(std::size_t const index, std::uint64_t, auto && make) -> bool {
+		auto & slot = slots()[index];
+		auto const was_deleted = traits::index(slot) == deleted;
+		bounded::destroy(slot);
+		try {
+			bounded::construct_at(slot, OPERATORS_FORWARD(make));
+		} catch (...) {
+			construct_marker(slot, was_deleted);
+			throw;
+		}
+		return was_deleted;
+	}
+
+	// Returns whether the slot is now marked as deleted. A search for a key
+	// stops at the first empty slot, so the slot can be marked empty if the
+	// slot after it already is.
+	constexpr auto erase(std::size_t const index) -> bool {
+		auto const next = (index + 1U) & (capacity() - 1U);
+		auto const leave_deleted = traits::index(slots()[next]) != empty;
+		auto & slot = slots()[index];
+		bounded::destroy(slot);
+		construct_marker(slot, leave_deleted);
+		return leave_deleted;
+	}
+
+private:
+	using traits = bounded::tombstone_traits<Value>;
+	using slots_t = containers::vector<Value>;
+	static constexpr auto empty = bounded::constant<0>;
+	static constexpr auto deleted = bounded::constant<1>;
+
+	static constexpr auto construct_marker(Value & slot, bool const is_deleted) noexcept -> void {
+		if (is_deleted) {
+			bounded::construct_at(slot, [] { return traits::make(deleted); });
+		} else {
+			bounded::construct_at(slot, [] { return traits::make(empty); });
+		}
+	}
+
+	slots_t m_slots;
+};
+
+// Each slot has a control byte that says whether it is empty, whether it held
+// an element that was erased, or holds the low seven bits of the hash of its
+// key. Searches check the control bytes of a group of slots at once, and look
+// at a slot only when its control byte matches.
+constexpr auto empty_control = std::uint8_t(0b1000'0000);
+constexpr auto deleted_control = std::uint8_t(0b1111'1110);
+
+// Bit `n` is set if slot `n` of a group matches
+using group_mask = std::uint32_t;
+
+constexpr auto group_width = std::size_t(16);
+
+// Outside of constant evaluation with SSE2, a group is compared with one
+// instruction. Otherwise, each half of a group is compared as a 64-bit integer.
+constexpr auto low_bits = std::uint64_t(0x0101'0101'0101'0101U);
+constexpr auto high_bits = std::uint64_t(0x8080'8080'8080'8080U);
+
+constexpr auto load_half_group(std::uint8_t const * const control) -> std::uint64_t {
+	auto result = std::uint64_t(0);
+	for (std::size_t n = 0; n != 8U; ++n) {
+		result |= static_cast<std::uint64_t>(control[n]) << (8U * n);
+	}
+	return result;
+}
+
+// Moves the high bit of byte `n` to bit `n`
+constexpr auto compress_high_bits(std::uint64_t const bytes) -> group_mask {
+	return static_cast<group_mask>(((bytes >> 7U) * 0x0102'0408'1020'4080U) >> 56U);
+}
+
+constexpr auto match_group(std::uint8_t const * const control, auto const match_half) -> group_mask {
+	return
+		::containers::compress_high_bits(match_half(::containers::load_half_group(control))) |
+		(::containers::compress_high_bits(match_half(::containers::load_half_group(control + 8))) << 8U);
+}
+
+// Sets the bit of every slot of the group whose control byte is equal to
+// `byte`. Without SSE2, this can also set it for slots after a match, so the
+// key in a slot that matches must still be checked.
+constexpr auto match_byte(std::uint8_t const * const control, std::uint8_t const byte) -> group_mask {
+#if defined(__SSE2__)
+	if !consteval {
+		auto const group = _mm_loadu_si128(reinterpret_cast<__m128i const *>(control));
+		return static_cast<group_mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(byte)))));
+	}
+#endif
+	return ::containers::match_group(control, [=](std::uint64_t const half) {
+		auto const difference = half ^ (low_bits * byte);
+		return (difference - low_bits) & ~difference & high_bits;
+	});
+}
+
+// Only `empty_control` has the high bit set and the second bit clear
+constexpr auto match_empty(std::uint8_t const * const control) -> group_mask {
+#if defined(__SSE2__)
+	if !consteval {
+		auto const group = _mm_loadu_si128(reinterpret_cast<__m128i const *>(control));
+		return static_cast<group_mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(empty_control)))));
+	}
+#endif
+	return ::containers::match_group(control, [](std::uint64_t const half) {
+		return half & ~(half << 6U) & high_bits;
+	});
+}
+
+constexpr auto match_empty_or_deleted(std::uint8_t const * const control) -> group_mask {
+#if defined(__SSE2__)
+	if !consteval {
+		return static_cast<group_mask>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(control))));
+	}
+#endif
+	return ::containers::match_group(control, [](std::uint64_t const half) {
+		return half & high_bits;
+	});
+}
+
+constexpr auto first_match(group_mask const match) -> std::size_t {
+	return static_cast<std::size_t>(std::countr_zero(match));
+}
+
+// For keys that have no spare representations. The groups are aligned to their
+// size and are probed in triangular steps, which visits every group once when
+// the number of groups is a power of two.
+template<typename Value>
+struct control_byte_table {
+	using value_type = Value;
+
+	// A search checks a whole group of slots at a time, so the table can be
+	// fuller than one that checks one slot at a time
+	static constexpr auto minimum_capacity = group_width;
+	static constexpr auto max_load(std::size_t const capacity_) -> std::size_t {
+		return capacity_ - capacity_ / 8U;
+	}
+
+	control_byte_table() = default;
+	constexpr explicit control_byte_table(std::size_t const capacity_):
+		m_control(containers::repeat_n(
+			::bounded::assume_in_range<range_size_t<control_t>>(capacity_),
+			empty_control
+		)),
+		m_slots(capacity_)
+	{
+	}
+
+	constexpr control_byte_table(control_byte_table const & other) requires std::is_copy_constructible_v<Value>:
+		control_byte_table(other.capacity())
+	{
+		for (auto index = other.next_full(0U); index != other.capacity(); index = other.next_full(index + 1U)) {
+			bounded::construct_at(slots()[index], [&] -> Value const & { return other.slots()[index]; });
+			control()[index] = other.control()[index];
+		}
+	}
+	control_byte_table(control_byte_table &&) = default;
+
+	constexpr auto operator=(control_byte_table const & other) & -> control_byte_table & requires std::is_copy_constructible_v<Value> {
+		if (this != std::addressof(other)) {
+			*this = control_byte_table(other);
+		}
+		return *this;
+	}
+	constexpr auto operator=(control_byte_table && other) & noexcept -> control_byte_table & {
+		if (this != std::addressof(other)) {
+			destroy_elements();
+			m_control = std::move(other.m_control);
+			m_slots = std::move(other.m_slots);
+		}
+		return *this;
+	}
+
+	constexpr ~control_byte_table() {
+		destroy_elements();
+	}
+
+	constexpr auto capacity() const -> std::size_t {
+		return static_cast<std::size_t>(containers::size(m_control));
+	}
+	constexpr auto slots() const -> Value const * {
+		return m_slots.data();
+	}
+	constexpr auto slots() -> Value * {
+		return m_slots.data();
+	}
+
+	constexpr auto next_full(std::size_t index) const -> std::size_t {
+		auto const capacity_ = capacity();
+		while (index != capacity_ and (control()[index] & empty_control) != 0U) {
+			++index;
+		}
+		return index;
+	}
+
+	// Returns `capacity()` if there is no match
+	constexpr auto find(std::uint64_t const hash, auto const matches) const -> std::size_t {
+		auto const capacity_ = capacity();
+		if (capacity_ == 0U) {
+			return capacity_;
+		}
+		auto const byte = hash_byte(hash);
+		auto group_start = first_group(hash);
+		for (std::size_t step = 1; ; ++step) {
+			auto const group = control() + group_start;
+			for (auto match = ::containers::match_byte(group, byte); match != 0U; match &= match - 1U) {
+				auto const index = group_start + ::containers::first_match(match);
+				if (matches(slots()[index])) {
+					return index;
+				}
+			}
+			if (::containers::match_empty(group) != 0U) {
+				return capacity_;
+			}
+			group_start = next_group(group_start, step);
+		}
+	}
+
+	constexpr auto insert_position(std::uint64_t const hash) const -> std::size_t {
+		auto group_start = first_group(hash);
+		for (std::size_t step = 1; ; ++step) {
+			auto const match = ::containers::match_empty_or_deleted(control() + group_start);
+			if (match != 0U) {
+				return group_start + ::containers::first_match(match);
+			}
+			group_start = next_group(group_start, step);
+		}
+	}
+
+	// Returns whether the slot was marked as deleted
+	constexpr auto construct(std::size_t const index, std::uint64_t const hash, auto && make) -> bool {
+		bounded::construct_at(slots()[index], OPERATORS_FORWARD(make));
+		auto const was_deleted = control()[index] == deleted_control;
+		control()[index] = hash_byte(hash);
+		return was_deleted;
+	}
+
+	// Returns whether the slot is now marked as deleted. A search stops at the
+	// first group with an empty slot, so the slot can be marked empty if its
+	// group already has one.
+	constexpr auto erase(std::size_t const index) -> bool {
+		bounded::destroy(slots()[index]);
+		auto const group_start = index & ~(group_width - 1U);
+		auto const leave_deleted = ::containers::match_empty(control() + group_start) == 0U;
+		control()[index] = leave_deleted ? deleted_control : empty_control;
+		return leave_deleted;
+	}
+
+private:
+	using control_t = containers::vector<std::uint8_t>;
+
+	constexpr auto control() const -> std::uint8_t const * {
+		return containers::data(m_control);
+	}
+	constexpr auto control() -> std::uint8_t * {
+		return containers::data(m_control);
+	}
+
+	static constexpr auto hash_byte(std::uint64_t const hash) -> std::uint8_t {
+		return static_cast<std::uint8_t>(hash & 0x7FU);
+	}
+	constexpr auto first_group(std::uint64_t const hash) const -> std::size_t {
+		return ::containers::probe_start(hash, capacity()) & ~(group_width - 1U);
+	}
+	constexpr auto next_group(std::size_t const group_start, std::size_t const step) const -> std::size_t {
+		return (group_start + step * group_width) & (capacity() - 1U);
+	}
+
+	constexpr auto destroy_elements() -> void {
+		for (auto index = next_full(0U); index != capacity(); index = next_full(index + 1U)) {
+			bounded::destroy(slots()[index]);
+		}
+	}
+
+	control_t m_control;
+	uninitialized_dynamic_array<Value, std::size_t> m_slots;
+};
+
+export template<typename Table>
+struct hash_map_iterator {
+	using difference_type = bounded::integer<
+		-maximum_array_size<typename Table::value_type>,
+		maximum_array_size<typename Table::value_type>
+	>;
+
+	hash_map_iterator() = default;
+	constexpr hash_map_iterator(Table & table, std::size_t const index):
+		m_table(std::addressof(table)),
+		m_index(index)
+	{
+	}
+
+	// Convert iterator to const_iterator
+	constexpr operator hash_map_iterator<Table const>() const requires(!std::is_const_v<Table>) {
+		return hash_map_iterator<Table const>(*m_table, m_index);
+	}
+
+	constexpr auto index() const -> std::size_t {
+		return m_index;
+	}
+
+	constexpr auto & operator*() const {
+		return m_table->slots()[m_index];
+	}
+	OPERATORS_ARROW_DEFINITIONS
+
+	friend auto operator==(hash_map_iterator, hash_map_iterator) -> bool = default;
+
+	friend constexpr auto operator+(hash_map_iterator const it, bounded::constant_t<1>) -> hash_map_iterator {
+		return hash_map_iterator(*it.m_table, it.m_table->next_full(it.m_index + 1U));
+	}
+
+private:
+	Table * m_table = nullptr;
+	std::size_t m_index = 0;
+};
+
+// An unordered map with open addressing. If the key has at least two spare
+// representations in its `bounded::tombstone_traits`, the table is just an
+// array of elements, and a slot without an element holds a key that means
+// "empty" or "deleted". Other keys use an array of control bytes next to the
+// array of elements.
+//
+// `ExtractKey` turns a key into what is hashed and compared. Integers hash to
+// themselves, and anything else uses `std::hash`. Inserting or erasing an
+// element invalidates all iterators.
+export template<typename Key, typename Mapped, typename ExtractKey = std::identity>
+class hash_map {
+public:
+	using key_type = Key;
+	using mapped_type = Mapped;
+	using value_type = std::conditional_t<
+		has_two_spare_representations<Key>,
+		hash_map_value<Key, Mapped>,
+		map_value_type<Key, Mapped>
+	>;
+
+private:
+	using table_t = std::conditional_t<
+		has_two_spare_representations<Key>,
+		tombstone_table<value_type>,
+		control_byte_table<value_type>
+	>;
+	using size_type = array_size_type<value_type>;
+
+public:
+	using const_iterator = hash_map_iterator<table_t const>;
+	using iterator = hash_map_iterator<table_t>;
+
+	constexpr auto extract_key() const {
+		return m_extract_key;
+	}
+
+	hash_map() = default;
+	hash_map(hash_map const &) = default;
+	constexpr hash_map(hash_map && other) noexcept:
+		m_table(std::move(other.m_table)),
+		m_size(std::exchange(other.m_size, bounded::constant<0>)),
+		m_deleted(std::exchange(other.m_deleted, 0U)),
+		m_extract_key(std::move(other.m_extract_key))
+	{
+	}
+	auto operator=(hash_map const &) & -> hash_map & = default;
+	constexpr auto operator=(hash_map && other) & noexcept -> hash_map & {
+		if (this != std::addressof(other)) {
+			m_table = std::move(other.m_table);
+			m_size = std::exchange(other.m_size, bounded::constant<0>);
+			m_deleted = std::exchange(other.m_deleted, 0U);
+			m_extract_key = std::move(other.m_extract_key);
+		}
+		return *this;
+	}
+
+	constexpr explicit hash_map(ExtractKey extract_key_):
+		m_extract_key(std::move(extract_key_))
+	{
+	}
+
+	template<range Source> requires(!std::same_as<std::remove_cvref_t<Source>, hash_map>)
+	constexpr explicit hash_map(Source && source, ExtractKey extract_key_ = ExtractKey()):
+		m_extract_key(std::move(extract_key_))
+	{
+		insert(OPERATORS_FORWARD(source));
+	}
+	template<std::size_t init_size>
+	constexpr hash_map(c_array<value_type, init_size> && source, ExtractKey extract_key_ = ExtractKey()):
+		m_extract_key(std::move(extract_key_))
+	{
+		reserve(bounded::constant<init_size>);
+		for (auto & value : source) {
+			lazy_insert(std::move(value.key), [&] -> Mapped && { return std::move(value.mapped); });
+		}
+	}
+
+	constexpr auto begin() const -> const_iterator {
+		return const_iterator(m_table, m_table.next_full(0U));
+	}
+	constexpr auto begin() -> iterator {
+		return iterator(m_table, m_table.next_full(0U));
+	}
+	constexpr auto end() const -> const_iterator {
+		return const_iterator(m_table, m_table.capacity());
+	}
+	constexpr auto end() -> iterator {
+		return iterator(m_table, m_table.capacity());
+	}
+	constexpr auto size() const -> size_type {
+		return m_size;
+	}
+
+	// The number of elements the map can hold before it rebuilds its table
+	constexpr auto capacity() const -> size_type {
+		return ::bounded::assume_in_range<size_type>(table_t::max_load(m_table.capacity()));
+	}
+	constexpr auto reserve(size_type const requested_capacity) -> void {
+		auto const new_capacity = ::containers::table_capacity_for<table_t>(static_cast<std::size_t>(requested_capacity));
+		if (new_capacity > m_table.capacity()) {
+			rehash(new_capacity);
+		}
+	}
+
+	constexpr auto find(auto const & key) const -> const_iterator {
+		return const_iterator(m_table, m_table.find(hash(key), matches(key)));
+	}
+	constexpr auto find(auto const & key) -> iterator {
+		return iterator(m_table, m_table.find(hash(key), matches(key)));
+	}
+
+	constexpr auto lazy_insert(auto && key, bounded::construct_function_for<mapped_type> auto && mapped) -> inserted_t<iterator> {
+		auto const key_hash = hash(key);
+		auto const found = m_table.find(key_hash, matches(key));
+		if (found != m_table.capacity()) {
+			return inserted_t{iterator(m_table, found), false};
+		}
+		auto const new_size = static_cast<std::size_t>(m_size) + 1U;
+		auto const capacity_ = m_table.capacity();
+		if (new_size + m_deleted > table_t::max_load(capacity_)) {
+			// If at most half of the load is elements, the rest is deleted
+			// slots, and rebuilding at the same size frees at least half of
+			// the table. Otherwise this grows, so there is never a rebuild
+			// for every few insertions.
+			rehash(2U * new_size > table_t::max_load(capacity_) ?
+				std::max(2U * capacity_, table_t::minimum_capacity) :
+				capacity_
+			);
+		}
+		auto const index = m_table.insert_position(key_hash);
+		auto const was_deleted = m_table.construct(index, key_hash, [&] {
+			return value_type{OPERATORS_FORWARD(key), OPERATORS_FORWARD(mapped)()};
+		});
+		if (was_deleted) {
+			--m_deleted;
+		}
+		++m_size;
+		return inserted_t{iterator(m_table, index), true};
+	}
+
+	template<range Range>
+	constexpr auto insert(Range && init) -> void {
+		if constexpr (sized_range<Range>) {
+			reserve(::bounded::assume_in_range<size_type>(m_size + containers::size(init)));
+		}
+		for (auto && value : OPERATORS_FORWARD(init)) {
+			lazy_insert(
+				get_key(OPERATORS_FORWARD(value)),
+				[&] -> decltype(auto) { return get_mapped(OPERATORS_FORWARD(value)); }
+			);
+		}
+	}
+
+	constexpr auto erase(const_iterator const it) -> iterator {
+		if (m_table.erase(it.index())) {
+			++m_deleted;
+		}
+		--m_size;
+		return iterator(m_table, m_table.next_full(it.index() + 1U));
+	}
+	constexpr auto erase(const_iterator first, const_iterator const last) -> iterator {
+		while (first != last) {
+			first = erase(first);
+		}
+		return iterator(m_table, last.index());
+	}
+
+	friend constexpr auto operator==(hash_map const & lhs, hash_map const & rhs) -> bool {
+		if (lhs.size() != rhs.size()) {
+			return false;
+		}
+		for (auto const & value : lhs) {
+			auto const it = rhs.find(value.key);
+			if (it == rhs.end() or !(it->mapped == value.mapped)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	constexpr auto hash(auto const & key) const -> std::uint64_t {
+		return ::containers::mix_hash(::containers::hash_key(m_extract_key(key)));
+	}
+	constexpr auto matches(auto const & key) const {
+		return [&](value_type const & value) {
+			return m_extract_key(value.key) == m_extract_key(key);
+		};
+	}
+
+	constexpr auto rehash(std::size_t const new_capacity) -> void {
+		auto original = std::exchange(m_table, table_t(new_capacity));
+		m_deleted = 0U;
+		for (auto index = original.next_full(0U); index != original.capacity(); index = original.next_full(index + 1U)) {
+			auto & value = original.slots()[index];
+			auto const key_hash = hash(value.key);
+			m_table.construct(m_table.insert_position(key_hash), key_hash, [&] -> value_type && { return std::move(value); });
+		}
+	}
+
+	table_t m_table;
+	size_type m_size = bounded::constant<0>;
+	std::size_t m_deleted = 0;
+	[[no_unique_address]] ExtractKey m_extract_key;
+};
+
+} // namespace containers
+
+template<typename Key, typename Mapped>
+struct bounded::tombstone_traits<containers::hash_map_value<Key, Mapped>> : bounded::tombstone_traits_composer<&containers::hash_map_value<Key, Mapped>::key> {
+};
+
+using namespace bounded::literal;
+
+using small_key = bounded::integer<0, 1000>;
+
+// The markers are in the key, so there is nothing else in a slot
+static_assert(sizeof(containers::hash_map_value<small_key, int>) == sizeof(containers::map_value_type<small_key, int>));
+static_assert(bounded::tombstone_traits<containers::hash_map_value<small_key, int>>::spare_representations >= 2_bi);
+static_assert(std::same_as<containers::hash_map<small_key, int>::value_type, containers::hash_map_value<small_key, int>>);
+static_assert(std::same_as<containers::hash_map<int, int>::value_type, containers::map_value_type<int, int>>);
+
+static_assert(containers::associative_container<containers::hash_map<small_key, int>>);
+static_assert(containers::associative_container<containers::hash_map<int, int>>);
+
+template<typename Key>
+constexpr auto make_key(int const key) -> Key {
+	return bounded::assume_in_range<Key>(key);
+}
+
+// Every third key in [0, 1000)
+template<typename Key>
+constexpr auto make_test_map() -> containers::hash_map<Key, int> {
+	auto map = containers::hash_map<Key, int>();
+	for (auto key = 0; key < 1000; key += 3) {
+		auto const result = map.lazy_insert(make_key<Key>(key), [=] { return key * 2; });
+		BOUNDED_ASSERT(result.inserted);
+		BOUNDED_ASSERT(result.iterator->key == make_key<Key>(key));
+	}
+	return map;
+}
+
+// Each test builds its own map so that no single constant evaluation is long
+// enough to reach the compiler's limit
+
+template<typename Key>
+constexpr auto test_insert_find() -> bool {
+	auto const empty = containers::hash_map<Key, int>();
+	BOUNDED_ASSERT(empty.find(make_key<Key>(5)) == containers::end(empty));
+	auto map = make_test_map<Key>();
+	BOUNDED_ASSERT(map.size() == 334_bi);
+	BOUNDED_ASSERT(!map.lazy_insert(make_key<Key>(3), [] { return -1; }).inserted);
+	for (auto key = 0; key < 1000; ++key) {
+		auto const mapped = containers::lookup(map, make_key<Key>(key));
+		if (key % 3 == 0) {
+			BOUNDED_ASSERT(mapped and *mapped == key * 2);
+		} else {
+			BOUNDED_ASSERT(mapped == nullptr);
+		}
+	}
+
+	auto count = 0;
+	for (auto const & value : map) {
+		BOUNDED_ASSERT(value.mapped == static_cast<int>(value.key) * 2);
+		++count;
+	}
+	BOUNDED_ASSERT(count == 334);
+	return true;
+}
+
+static_assert(test_insert_find<small_key>());
+static_assert(test_insert_find<int>());
+
+template<typename Key>
+constexpr auto erase_every_sixth(containers::hash_map<Key, int> & map) -> void {
+	for (auto key = 0; key < 1000; key += 6) {
+		map.erase(map.find(make_key<Key>(key)));
+	}
+}
+
+template<typename Key>
+constexpr auto test_erase() -> bool {
+	auto map = make_test_map<Key>();
+	// Erasing leaves deleted slots, which must not end a search
+	erase_every_sixth(map);
+	BOUNDED_ASSERT(map.size() == 167_bi);
+	for (auto key = 0; key < 1000; key += 3) {
+		BOUNDED_ASSERT((map.find(make_key<Key>(key)) == containers::end(map)) == (key % 6 == 0));
+	}
+
+	auto const copy = map;
+	BOUNDED_ASSERT(copy == map);
+	map.erase(map.begin());
+	BOUNDED_ASSERT(copy != map);
+	return true;
+}
+
+static_assert(test_erase<small_key>());
+static_assert(test_erase<int>());
+
+template<typename Key>
+constexpr auto test_churn() -> bool {
+	auto map = make_test_map<Key>();
+	erase_every_sixth(map);
+	// Enough churn to fill the table with deleted slots several times
+	for (auto round = 0; round != 8; ++round) {
+		for (auto key = 1; key < 1000; key += 6) {
+			BOUNDED_ASSERT(map.lazy_insert(make_key<Key>(key), [=] { return round; }).inserted);
+		}
+		for (auto key = 1; key < 1000; key += 6) {
+			map.erase(map.find(make_key<Key>(key)));
+		}
+	}
+	BOUNDED_ASSERT(map.size() == 167_bi);
+	for (auto key = 0; key < 1000; ++key) {
+		BOUNDED_ASSERT((map.find(make_key<Key>(key)) != containers::end(map)) == (key % 6 == 3));
+	}
+	return true;
+}
+
+static_assert(test_churn<small_key>());
+static_assert(test_churn<int>());
+
+template<typename Key>
+constexpr auto test_non_copyable() -> bool {
+	auto map = containers::hash_map<Key, bounded_test::non_copyable_integer>();
+	for (auto key = 0; key != 100; ++key) {
+		map.lazy_insert(make_key<Key>(key), [=] { return bounded_test::non_copyable_integer(key); });
+	}
+	auto moved = std::move(map);
+	BOUNDED_ASSERT(moved.size() == 100_bi);
+	BOUNDED_ASSERT(*containers::lookup(moved, make_key<Key>(42)) == bounded_test::non_copyable_integer(42));
+
+	// The moved-from map is empty and can be used again
+	BOUNDED_ASSERT(map.size() == 0_bi);
+	BOUNDED_ASSERT(containers::begin(map) == containers::end(map));
+	BOUNDED_ASSERT(map.lazy_insert(make_key<Key>(7), [] { return bounded_test::non_copyable_integer(7); }).inserted);
+	BOUNDED_ASSERT(map.size() == 1_bi);
+
+	moved = std::move(map);
+	BOUNDED_ASSERT(moved.size() == 1_bi);
+	BOUNDED_ASSERT(map.size() == 0_bi);
+	BOUNDED_ASSERT(containers::begin(map) == containers::end(map));
+	return true;
+}
+
+static_assert(test_non_copyable<small_key>());
+static_assert(test_non_copyable<int>());
+
+static_assert([] {
+	auto const map = containers::hash_map<int, int>({{1, 10}, {2, 20}, {1, 30}});
+	return map.size() == 2_bi and *containers::lookup(map, 1) == 10;
+}());
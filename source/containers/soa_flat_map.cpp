@@ -0,0 +1,539 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+#include <operators/forward.hpp>
+
+export module containers.soa_flat_map;
+
+import containers.algorithms.sort.is_sorted;
+import containers.algorithms.sort.sort_permutation;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.advance;
+import containers.algorithms.binary_search;
+import containers.algorithms.compare;
+import containers.algorithms.erase;
+import containers.array;
+import containers.associative_container;
+import containers.begin_end;
+import containers.c_array;
+import containers.dereference;
+import containers.extract_key_to_less;
+import containers.front_back;
+import containers.insert;
+import containers.is_empty;
+import containers.is_iterator;
+import containers.is_range;
+import containers.iter_difference_t;
+import containers.iter_reference_t;
+import containers.iterator_t;
+import containers.lookup;
+import containers.map_tags;
+import containers.map_value_type;
+import containers.push_back;
+import containers.range_view;
+import containers.size;
+import containers.vector;
+export import containers.common_iterator_functions;
+
+import bounded;
+import bounded.test_int;
+import std_module;
+
+namespace containers {
+
+// What a `soa_flat_map` iterator refers to. The key and the mapped value are
+// in different arrays, so this holds a reference to each of them rather than
+// being a reference to a `map_value_type`.
+export template<typename Key, typename Mapped>
+struct soa_flat_map_reference {
+	constexpr operator map_value_type<std::remove_cvref_t<Key>, std::remove_cvref_t<Mapped>>() const {
+		return {key, mapped};
+	}
+
+	friend constexpr auto operator==(soa_flat_map_reference const lhs, soa_flat_map_reference const rhs) -> bool {
+		return lhs.key == rhs.key and lhs.mapped == rhs.mapped;
+	}
+	template<typename OtherKey, typename OtherMapped>
+	friend constexpr auto operator==(soa_flat_map_reference const lhs, map_value_type<OtherKey, OtherMapped> const & rhs) -> bool {
+		return lhs.key == rhs.key and lhs.mapped == rhs.mapped;
+	}
+
+	Key key;
+	Mapped mapped;
+};
+
+constexpr auto iterator_at_index(auto const first, std::size_t const index) {
+	return first + ::bounded::assume_in_range<iter_difference_t<decltype(first)>>(index);
+}
+
+export template<typename KeyIterator, typename MappedIterator>
+struct soa_flat_map_iterator {
+	using difference_type = iter_difference_t<KeyIterator>;
+
+	soa_flat_map_iterator() = default;
+	constexpr soa_flat_map_iterator(KeyIterator key, MappedIterator mapped):
+		m_key(std::move(key)),
+		m_mapped(std::move(mapped))
+	{
+	}
+
+	// Convert iterator to const_iterator
+	template<typename OtherMappedIterator> requires(!std::same_as<OtherMappedIterator, MappedIterator> and bounded::convertible_to<MappedIterator, OtherMappedIterator>)
+	constexpr operator soa_flat_map_iterator<KeyIterator, OtherMappedIterator>() const {
+		return soa_flat_map_iterator<KeyIterator, OtherMappedIterator>(m_key, m_mapped);
+	}
+
+	constexpr auto key_iterator() const {
+		return m_key;
+	}
+	constexpr auto mapped_iterator() const {
+		return m_mapped;
+	}
+
+	constexpr auto operator*() const {
+		return soa_flat_map_reference<iter_reference_t<KeyIterator>, iter_reference_t<MappedIterator>>{*m_key, *m_mapped};
+	}
+
+	friend constexpr auto operator+(soa_flat_map_iterator const lhs, difference_type const rhs) -> soa_flat_map_iterator {
+		return soa_flat_map_iterator(
+			lhs.m_key + rhs,
+			lhs.m_mapped + ::bounded::assume_in_range<iter_difference_t<MappedIterator>>(rhs)
+		);
+	}
+	friend constexpr auto operator-(soa_flat_map_iterator const lhs, soa_flat_map_iterator const rhs) -> difference_type {
+		return lhs.m_key - rhs.m_key;
+	}
+	friend constexpr auto operator<=>(soa_flat_map_iterator const lhs, soa_flat_map_iterator const rhs) {
+		return lhs.m_key <=> rhs.m_key;
+	}
+	friend constexpr auto operator==(soa_flat_map_iterator const lhs, soa_flat_map_iterator const rhs) -> bool {
+		return lhs.m_key == rhs.m_key;
+	}
+
+private:
+	KeyIterator m_key;
+	MappedIterator m_mapped;
+};
+
+// Converts a key that is looked up to `Key` before extracting from it, like
+// `extract_map_key` in `flat_map`. Without this, an extractor that depends on
+// the type, such as `to_radix_sort_key` of a bounded integer, would give keys
+// of another type a value that cannot be compared with the stored keys.
+template<typename Key, typename ExtractKey>
+struct extract_soa_key {
+	constexpr explicit extract_soa_key(ExtractKey extract_key):
+		m_extract(std::move(extract_key))
+	{
+	}
+	constexpr decltype(auto) operator()(Key const & key) const {
+		return m_extract(key);
+	}
+private:
+	ExtractKey m_extract;
+};
+
+// A sorted map that stores its keys in one array and its mapped values in
+// another, so that looking up a key reads only keys. This is faster than
+// `flat_map` when the mapped values are much larger than the keys. Iterators
+// refer to a key and a mapped value in the same way as `flat_map`, but through
+// a `soa_flat_map_reference` rather than a `map_value_type` reference.
+export template<typename Key, typename Mapped, typename ExtractKey = to_radix_sort_key_t>
+class soa_flat_map {
+private:
+	using keys_t = containers::vector<Key>;
+	using mapped_values_t = containers::vector<Mapped>;
+public:
+	using key_type = Key;
+	using mapped_type = Mapped;
+	using value_type = map_value_type<Key, Mapped>;
+
+	using const_iterator = soa_flat_map_iterator<iterator_t<keys_t const &>, iterator_t<mapped_values_t const &>>;
+	using iterator = soa_flat_map_iterator<iterator_t<keys_t const &>, iterator_t<mapped_values_t &>>;
+
+	constexpr auto extract_key() const {
+		return m_extract_key;
+	}
+	constexpr auto compare() const {
+		return ::containers::extract_key_to_less(extract_soa_key<Key, ExtractKey>(m_extract_key));
+	}
+
+	soa_flat_map() = default;
+	constexpr explicit soa_flat_map(ExtractKey extract_key_):
+		m_extract_key(std::move(extract_key_))
+	{
+	}
+
+	// `keys` and `mapped_values` are the two columns of the map. The mapped
+	// value for `keys[n]` is `mapped_values[n]`.
+	constexpr soa_flat_map(keys_t keys_, mapped_values_t mapped_values_, ExtractKey extract_key_ = ExtractKey()):
+		m_keys(std::move(keys_)),
+		m_mapped(std::move(mapped_values_)),
+		m_extract_key(std::move(extract_key_))
+	{
+		BOUNDED_ASSERT(containers::size(m_keys) == containers::size(m_mapped));
+		merge_new_elements(0);
+	}
+	constexpr soa_flat_map(assume_sorted_unique_t, keys_t keys_, mapped_values_t mapped_values_, ExtractKey extract_key_ = ExtractKey()):
+		m_keys(std::move(keys_)),
+		m_mapped(std::move(mapped_values_)),
+		m_extract_key(std::move(extract_key_))
+	{
+		BOUNDED_ASSERT(containers::size(m_keys) == containers::size(m_mapped));
+		BOUNDED_ASSERT(is_sorted(m_keys, compare()));
+	}
+
+	template<range Source> requires(!std::same_as<std::remove_cvref_t<Source>, soa_flat_map>)
+	constexpr explicit soa_flat_map(Source && source, ExtractKey extract_key_ = ExtractKey()):
+		m_extract_key(std::move(extract_key_))
+	{
+		append_unsorted(OPERATORS_FORWARD(source));
+		merge_new_elements(0);
+	}
+	template<range Source>
+	constexpr soa_flat_map(assume_unique_t, Source && source, ExtractKey extract_key_ = ExtractKey()):
+		soa_flat_map(OPERATORS_FORWARD(source), std::move(extract_key_))
+	{
+	}
+	template<range Source>
+	constexpr soa_flat_map(assume_sorted_unique_t, Source && source, ExtractKey extract_key_ = ExtractKey()):
+		m_extract_key(std::move(extract_key_))
+	{
+		append_unsorted(OPERATORS_FORWARD(source));
+		BOUNDED_ASSERT(is_sorted(m_keys, compare()));
+	}
+
+	template<std::size_t init_size>
+	constexpr soa_flat_map(c_array<value_type, init_size> && source, ExtractKey extract_key_ = ExtractKey()):
+		m_extract_key(std::move(extract_key_))
+	{
+		for (auto & value : source) {
+			::containers::push_back(m_keys, std::move(value.key));
+			::containers::push_back(m_mapped, std::move(value.mapped));
+		}
+		merge_new_elements(0);
+	}
+
+	constexpr auto begin() const -> const_iterator {
+		return const_iterator(containers::begin(m_keys), containers::begin(m_mapped));
+	}
+	constexpr auto begin() -> iterator {
+		return iterator(containers::begin(std::as_const(m_keys)), containers::begin(m_mapped));
+	}
+	constexpr auto size() const {
+		return containers::size(m_keys);
+	}
+
+	// The sorted keys, which can be searched or iterated over without
+	// touching any mapped values
+	constexpr auto keys() const -> keys_t const & {
+		return m_keys;
+	}
+	constexpr auto mapped_values() const -> mapped_values_t const & {
+		return m_mapped;
+	}
+
+	constexpr auto capacity() const {
+		return bounded::min(m_keys.capacity(), m_mapped.capacity());
+	}
+	constexpr auto reserve(range_size_t<keys_t> const new_capacity) -> void {
+		m_keys.reserve(new_capacity);
+		m_mapped.reserve(::bounded::assume_in_range<range_size_t<mapped_values_t>>(new_capacity));
+	}
+
+	constexpr auto find(auto const & key) const {
+		return find_impl(*this, key);
+	}
+	constexpr auto find(auto const & key) {
+		return find_impl(*this, key);
+	}
+
+	template<typename K = key_type>
+	constexpr auto lazy_insert(K && key, bounded::construct_function_for<mapped_type> auto && mapped) {
+		auto const position = containers::upper_bound(m_keys, key, compare());
+		auto const index = static_cast<std::size_t>(position - containers::begin(m_keys));
+		if (index != 0 and !compare()(*containers::prev(position), key)) {
+			return inserted_t{::containers::iterator_at_index(begin(), index - 1U), false};
+		}
+		// The mapped value is constructed first so that the map is unchanged if
+		// that throws. If inserting the key throws, the mapped value is erased
+		// again so that both columns stay the same size.
+		::containers::lazy_insert(m_mapped, ::containers::iterator_at_index(containers::begin(std::as_const(m_mapped)), index), OPERATORS_FORWARD(mapped));
+		auto guard = bounded::scope_guard([&] {
+			::containers::erase(m_mapped, ::containers::iterator_at_index(containers::begin(std::as_const(m_mapped)), index));
+		});
+		::containers::lazy_insert(m_keys, position, [&] { return key_type(OPERATORS_FORWARD(key)); });
+		guard.dismiss();
+		return inserted_t{::containers::iterator_at_index(begin(), index), true};
+	}
+
+	constexpr auto insert(range auto && init) -> void {
+		auto const original_size = static_cast<std::size_t>(size());
+		append_unsorted(OPERATORS_FORWARD(init));
+		merge_new_elements(original_size);
+	}
+
+	// `Other` is required to be a unique range of elements
+	template<range Other>
+	constexpr auto upsert(Other && other, auto && update) -> void {
+		auto const original_size = static_cast<std::size_t>(size());
+		auto const last = containers::end(OPERATORS_FORWARD(other));
+		for (auto it = containers::begin(OPERATORS_FORWARD(other)); it != last; ++it) {
+			auto && value = dereference<Other>(it);
+			// Only the original elements are sorted
+			auto const original_keys = range_view(
+				containers::begin(m_keys),
+				::containers::iterator_at_index(containers::begin(m_keys), original_size)
+			);
+			auto const key = containers::lower_bound(original_keys, get_key(value), compare());
+			if (key != containers::end(original_keys) and !compare()(get_key(value), *key)) {
+				auto const index = static_cast<std::size_t>(key - containers::begin(m_keys));
+				update(*::containers::iterator_at_index(containers::begin(m_mapped), index), ::containers::get_mapped(OPERATORS_FORWARD(value)));
+			} else {
+				::containers::push_back(m_keys, ::containers::get_key(OPERATORS_FORWARD(value)));
+				::containers::push_back(m_mapped, ::containers::get_mapped(OPERATORS_FORWARD(value)));
+			}
+		}
+		merge_new_elements(original_size);
+	}
+
+	constexpr auto erase(const_iterator const it) -> iterator {
+		BOUNDED_ASSERT(it != containers::end(*this));
+		return erase(it, ::containers::next(it));
+	}
+	constexpr auto erase(const_iterator const first, const_iterator const last) -> iterator {
+		auto const offset = first - begin();
+		::containers::erase(m_keys, first.key_iterator(), last.key_iterator());
+		::containers::erase(m_mapped, first.mapped_iterator(), last.mapped_iterator());
+		return begin() + offset;
+	}
+	constexpr auto erase_if(auto const predicate) {
+		auto const original_size = static_cast<std::size_t>(size());
+		auto kept = std::size_t(0);
+		auto const keys = containers::begin(m_keys);
+		auto const mapped = containers::begin(m_mapped);
+		for (auto index = std::size_t(0); index != original_size; ++index) {
+			auto & key = *::containers::iterator_at_index(keys, index);
+			auto & mapped_value = *::containers::iterator_at_index(mapped, index);
+			if (predicate(soa_flat_map_reference<key_type const &, mapped_type &>{key, mapped_value})) {
+				continue;
+			}
+			if (kept != index) {
+				*::containers::iterator_at_index(keys, kept) = std::move(key);
+				*::containers::iterator_at_index(mapped, kept) = std::move(mapped_value);
+			}
+			++kept;
+		}
+		containers::erase_to_end(m_keys, ::containers::iterator_at_index(containers::begin(m_keys), kept));
+		containers::erase_to_end(m_mapped, ::containers::iterator_at_index(containers::begin(m_mapped), kept));
+		return original_size - kept;
+	}
+
+	friend constexpr auto operator==(soa_flat_map const & lhs, soa_flat_map const & rhs) -> bool {
+		return lhs.m_keys == rhs.m_keys and lhs.m_mapped == rhs.m_mapped;
+	}
+
+private:
+	static constexpr auto find_impl(auto & map, auto const & key) {
+		auto const it = containers::lower_bound(map.m_keys, key, map.compare());
+		if (it == containers::end(map.m_keys) or map.compare()(key, *it)) {
+			return containers::end(map);
+		}
+		return containers::begin(map) + (it - containers::begin(map.m_keys));
+	}
+
+	template<typename Source>
+	constexpr auto append_unsorted(Source && source) -> void {
+		auto const last = containers::end(OPERATORS_FORWARD(source));
+		for (auto it = containers::begin(OPERATORS_FORWARD(source)); it != last; ++it) {
+			auto && value = dereference<Source>(it);
+			::containers::push_back(m_keys, ::containers::get_key(OPERATORS_FORWARD(value)));
+			::containers::push_back(m_mapped, ::containers::get_mapped(OPERATORS_FORWARD(value)));
+		}
+	}
+
+	// Sorts the elements starting at `midpoint` and merges them into the sorted
+	// elements before it. The order is worked out on the keys alone and then
+	// applied to both arrays, so each mapped value is moved at most twice. If
+	// a key is in the map more than once, the first copy is kept, which means
+	// elements already in the map are kept over new elements.
+	constexpr auto merge_new_elements(std::size_t const midpoint) -> void {
+		auto const original_size = static_cast<std::size_t>(size());
+		if (midpoint == original_size) {
+			return;
+		}
+		{
+			auto const new_keys = range_view(::containers::iterator_at_index(containers::begin(m_keys), midpoint), containers::end(m_keys));
+			auto const permutation = ::containers::sort_permutation(new_keys, m_extract_key);
+			::containers::apply_permutation_inplace(new_keys, permutation);
+			::containers::apply_permutation_inplace(
+				range_view(::containers::iterator_at_index(containers::begin(m_mapped), midpoint), containers::end(m_mapped)),
+				permutation
+			);
+		}
+
+		auto const keys = containers::begin(m_keys);
+		auto const key_at = [&](std::size_t const index) -> key_type const & {
+			return *::containers::iterator_at_index(keys, index);
+		};
+		auto const less = compare();
+		using indexes_t = containers::vector<std::size_t>;
+		auto permutation = indexes_t();
+		permutation.reserve(::bounded::assume_in_range<range_size_t<indexes_t>>(original_size));
+		auto duplicates = indexes_t();
+		auto add_new = [&](std::size_t const index) {
+			if (containers::is_empty(permutation) or less(key_at(containers::back(permutation)), key_at(index))) {
+				::containers::push_back(permutation, index);
+			} else {
+				::containers::push_back(duplicates, index);
+			}
+		};
+		auto old_index = std::size_t(0);
+		auto new_index = midpoint;
+		while (old_index != midpoint and new_index != original_size) {
+			if (less(key_at(new_index), key_at(old_index))) {
+				add_new(new_index);
+				++new_index;
+			} else {
+				::containers::push_back(permutation, old_index);
+				++old_index;
+			}
+		}
+		for (; old_index != midpoint; ++old_index) {
+			::containers::push_back(permutation, old_index);
+		}
+		for (; new_index != original_size; ++new_index) {
+			add_new(new_index);
+		}
+
+		auto const unique_size = static_cast<std::size_t>(containers::size(permutation));
+		for (auto const index : duplicates) {
+			::containers::push_back(permutation, index);
+		}
+		::containers::apply_permutation_inplace(m_keys, permutation);
+		::containers::apply_permutation_inplace(m_mapped, permutation);
+		containers::erase_to_end(m_keys, ::containers::iterator_at_index(containers::begin(m_keys), unique_size));
+		containers::erase_to_end(m_mapped, ::containers::iterator_at_index(containers::begin(m_mapped), unique_size));
+	}
+
+	keys_t m_keys;
+	mapped_values_t m_mapped;
+	[[no_unique_address]] ExtractKey m_extract_key;
+};
+
+} // namespace containers
+
+using namespace bounded::literal;
+
+using map_type = containers::soa_flat_map<int, int>;
+using value_type = containers::map_value_type<int, int>;
+
+static_assert(containers::random_access_iterator<map_type::iterator>);
+static_assert(containers::random_access_iterator<map_type::const_iterator>);
+static_assert(containers::associative_range<map_type>);
+static_assert(containers::associative_range<map_type const &>);
+
+static_assert(map_type() == map_type());
+static_assert(containers::size(map_type()) == 0_bi);
+
+constexpr auto unsorted = containers::array<value_type, 5_bi>({{3, 30}, {1, 10}, {4, 40}, {1, 10}, {2, 20}});
+constexpr auto sorted = containers::array<value_type, 4_bi>({{1, 10}, {2, 20}, {3, 30}, {4, 40}});
+
+static_assert(containers::equal(map_type(unsorted), sorted));
+static_assert(containers::equal(map_type(containers::assume_sorted_unique, sorted), sorted));
+static_assert(containers::equal(
+	map_type(containers::vector<int>({3, 1, 2}), containers::vector<int>({30, 10, 20})),
+	containers::array<value_type, 3_bi>({{1, 10}, {2, 20}, {3, 30}})
+));
+static_assert(map_type(unsorted).keys() == containers::vector<int>({1, 2, 3, 4}));
+static_assert(map_type(unsorted).mapped_values() == containers::vector<int>({10, 20, 30, 40}));
+
+static_assert([] {
+	auto const map = map_type(unsorted);
+	BOUNDED_ASSERT(map.find(0) == containers::end(map));
+	BOUNDED_ASSERT(map.find(5) == containers::end(map));
+	BOUNDED_ASSERT(*containers::lookup(map, 3) == 30);
+	return containers::get_mapped(*map.find(2)) == 20;
+}());
+
+static_assert([] {
+	auto map = map_type(unsorted);
+	*containers::lookup(map, 4) = 44;
+	return *containers::lookup(map, 4) == 44;
+}());
+
+static_assert([] {
+	auto map = map_type(sorted);
+	auto const inserted = map.lazy_insert(0, bounded::value_to_function(0));
+	BOUNDED_ASSERT(inserted.inserted);
+	BOUNDED_ASSERT(inserted.iterator == containers::begin(map));
+	auto const existing = map.lazy_insert(3, bounded::value_to_function(0));
+	BOUNDED_ASSERT(!existing.inserted);
+	BOUNDED_ASSERT(containers::get_mapped(*existing.iterator) == 30);
+	return containers::equal(map, containers::array<value_type, 5_bi>({{0, 0}, {1, 10}, {2, 20}, {3, 30}, {4, 40}}));
+}());
+
+static_assert([] {
+	auto map = map_type(containers::array<value_type, 2_bi>({{2, 20}, {4, 40}}));
+	map.insert(containers::array<value_type, 4_bi>({{4, 0}, {3, 30}, {1, 10}, {3, 30}}));
+	return containers::equal(map, sorted);
+}());
+
+constexpr auto add = [](auto & lhs, auto const & rhs) {
+	lhs += rhs;
+};
+
+static_assert([] {
+	auto map = map_type(containers::array<value_type, 2_bi>({{1, 1}, {3, 3}}));
+	map.upsert(containers::array<value_type, 3_bi>({{4, 40}, {1, 9}, {2, 20}}), add);
+	return containers::equal(map, containers::array<value_type, 4_bi>({{1, 10}, {2, 20}, {3, 3}, {4, 40}}));
+}());
+
+static_assert([] {
+	auto map = map_type(sorted);
+	map.upsert(map_type(unsorted), add);
+	return map.mapped_values() == containers::vector<int>({20, 40, 60, 80});
+}());
+
+static_assert([] {
+	auto map = map_type(sorted);
+	auto const it = map.erase(containers::begin(map) + 1_bi);
+	BOUNDED_ASSERT(containers::get_key(*it) == 3);
+	BOUNDED_ASSERT(map.erase_if([](auto const value) { return value.key == 1 or value.mapped == 40; }) == 2U);
+	return containers::equal(map, containers::array<value_type, 1_bi>({{3, 30}}));
+}());
+
+// The radix key of a bounded integer depends on its minimum, so a key of a
+// different type must be converted before it is compared
+using offset_key = bounded::integer<1000, 1255>;
+using offset_map_type = containers::soa_flat_map<offset_key, int>;
+
+static_assert([] {
+	auto map = offset_map_type();
+	for (auto const key : {1100, 1000, 1255, 1050}) {
+		map.lazy_insert(bounded::assume_in_range<offset_key>(key), bounded::value_to_function(key));
+	}
+	BOUNDED_ASSERT(map.lazy_insert(1200_bi, bounded::value_to_function(1200)).inserted);
+	BOUNDED_ASSERT(!map.lazy_insert(1100_bi, bounded::value_to_function(0)).inserted);
+	BOUNDED_ASSERT(containers::is_sorted(map.keys()));
+	BOUNDED_ASSERT(*containers::lookup(map, 1100_bi) == 1100);
+	BOUNDED_ASSERT(*containers::lookup(map, 1000_bi) == 1000);
+	BOUNDED_ASSERT(map.find(1101_bi) == containers::end(map));
+	return containers::get_mapped(*map.find(1255_bi)) == 1255;
+}());
+
+using non_copyable_map = containers::soa_flat_map<int, bounded_test::non_copyable_integer>;
+
+static_assert([] {
+	auto map = non_copyable_map();
+	map.lazy_insert(2, [] { return bounded_test::non_copyable_integer(20); });
+	map.lazy_insert(1, [] { return bounded_test::non_copyable_integer(10); });
+	map.erase_if([](auto const value) { return value.key == 2; });
+	return containers::size(map) == 1_bi and containers::lookup(map, 1)->value() == 10;
+}());
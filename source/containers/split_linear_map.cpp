@@ -0,0 +1,237 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+#include <operators/forward.hpp>
+
+export module containers.split_linear_map;
+
+import containers.algorithms.advance;
+import containers.algorithms.erase;
+import containers.algorithms.transform;
+import containers.begin_end;
+import containers.c_array;
+import containers.compare_container;
+import containers.data;
+import containers.initializer_range;
+import containers.is_range;
+import containers.iterator_t;
+import containers.lazy_push_back;
+import containers.lookup;
+import containers.map_tags;
+import containers.map_value_type;
+import containers.maximum_array_size;
+import containers.pop_back;
+import containers.push_back;
+import containers.range_value_t;
+import containers.size;
+import containers.static_vector;
+import containers.test_associative_container;
+import containers.test_reserve_and_capacity;
+import containers.vector;
+
+import bounded;
+import bounded.test_int;
+import std_module;
+
+namespace containers {
+
+// One cache line of keys
+template<typename Key>
+constexpr auto key_block_size = 64U / sizeof(Key);
+
+// Returns the index of `key` in `keys`, or `size` if it is not there. Each
+// block of keys is compared all at once, without branching, so the compiler
+// can turn the comparisons into vector instructions. Only the block that has
+// the key is searched again one key at a time.
+template<typename Key>
+constexpr auto find_key_index(Key const * const keys, std::size_t const size, auto const & key) -> std::size_t {
+	auto index = std::size_t(0);
+	for (; index + key_block_size<Key> <= size; index += key_block_size<Key>) {
+		// `|=` on a `bool` is not vectorized by gcc
+		auto found = 0U;
+		for (std::size_t offset = 0; offset != key_block_size<Key>; ++offset) {
+			found |= keys[index + offset] == key ? 1U : 0U;
+		}
+		if (found != 0U) {
+			break;
+		}
+	}
+	for (; index != size; ++index) {
+		if (keys[index] == key) {
+			return index;
+		}
+	}
+	return size;
+}
+
+// A `basic_linear_map` that also keeps a copy of each key in a separate
+// container, in the same order as the elements. `find` then reads only keys,
+// which are next to each other and are compared many at a time. This keeps a
+// linear search faster than a binary search for up to a few hundred elements
+// with integer or enum keys.
+//
+// Keys must not be changed through an iterator.
+export template<typename Container, typename KeyContainer>
+struct basic_split_linear_map : private lexicographical_comparison::base {
+	using value_type = range_value_t<Container>;
+	using key_type = typename value_type::key_type;
+	using mapped_type = typename value_type::mapped_type;
+	static_assert(bounded::isomorphic_to_integral<key_type>);
+	static_assert(std::same_as<range_value_t<KeyContainer>, key_type>);
+
+	using const_iterator = iterator_t<Container const &>;
+	using iterator = iterator_t<Container &>;
+
+	basic_split_linear_map() = default;
+
+	constexpr explicit basic_split_linear_map(constructor_initializer_range<basic_split_linear_map> auto && source) {
+		insert(OPERATORS_FORWARD(source));
+	}
+	constexpr basic_split_linear_map(assume_unique_t, constructor_initializer_range<basic_split_linear_map> auto && source):
+		m_container(OPERATORS_FORWARD(source)),
+		m_keys(keys_of(m_container))
+	{
+	}
+
+	template<std::size_t init_size>
+	constexpr basic_split_linear_map(c_array<value_type, init_size> && source) {
+		for (auto & value : source) {
+			lazy_insert(std::move(value.key), [&] -> mapped_type && { return std::move(value.mapped); });
+		}
+	}
+	template<std::size_t init_size>
+	constexpr basic_split_linear_map(assume_unique_t, c_array<value_type, init_size> && source):
+		m_container(std::move(source)),
+		m_keys(keys_of(m_container))
+	{
+	}
+
+	constexpr auto begin() const {
+		return ::containers::begin(m_container);
+	}
+	constexpr auto begin() {
+		return ::containers::begin(m_container);
+	}
+	constexpr auto end() const {
+		return ::containers::end(m_container);
+	}
+	constexpr auto end() {
+		return ::containers::end(m_container);
+	}
+
+	constexpr auto capacity() const {
+		return m_container.capacity();
+	}
+	constexpr auto reserve(range_size_t<Container> const new_capacity) {
+		m_keys.reserve(new_capacity);
+		return m_container.reserve(new_capacity);
+	}
+
+	// O(n) time
+	constexpr auto find(auto const & key) const -> const_iterator {
+		return begin() + find_index(key);
+	}
+	// O(n) time
+	constexpr auto find(auto const & key) -> iterator {
+		return begin() + find_index(key);
+	}
+
+	// O(n) time
+	constexpr auto lazy_insert(auto && key, bounded::construct_function_for<mapped_type> auto && mapped) {
+		auto const it = find(key);
+		if (it != end()) {
+			return inserted_t{it, false};
+		}
+		::containers::push_back(m_keys, key_type(key));
+		auto guard = bounded::scope_guard([&] { ::containers::pop_back(m_keys); });
+		::containers::lazy_push_back(
+			m_container,
+			[&] { return value_type{OPERATORS_FORWARD(key), OPERATORS_FORWARD(mapped)()}; }
+		);
+		guard.dismiss();
+		return inserted_t{containers::prev(end()), true};
+	}
+
+	// O(n * m) time
+	template<range Range>
+	constexpr auto insert(Range && init) -> void {
+		for (auto && value : OPERATORS_FORWARD(init)) {
+			lazy_insert(
+				get_key(value),
+				[&] -> decltype(auto) { return get_mapped(OPERATORS_FORWARD(value)); }
+			);
+		}
+	}
+	constexpr auto erase(const_iterator const it) {
+		containers::erase(m_keys, key_iterator(it));
+		return containers::erase(m_container, it);
+	}
+	constexpr auto erase(const_iterator const first, const_iterator const last) {
+		containers::erase(m_keys, key_iterator(first), key_iterator(last));
+		return containers::erase(m_container, first, last);
+	}
+
+private:
+	static constexpr auto keys_of(Container const & elements) -> KeyContainer {
+		return KeyContainer(containers::transform(elements, [](value_type const & value) { return value.key; }));
+	}
+	constexpr auto find_index(auto const & key) const {
+		auto const size_ = static_cast<std::size_t>(containers::size(m_keys));
+		auto const index = ::containers::find_key_index(containers::data(m_keys), size_, key);
+		return ::bounded::assume_in_range<range_size_t<Container>>(index);
+	}
+	constexpr auto key_iterator(const_iterator const it) const {
+		return containers::begin(m_keys) + (it - begin());
+	}
+
+	Container m_container;
+	KeyContainer m_keys;
+};
+
+export template<typename Key, typename T>
+using split_linear_map = basic_split_linear_map<vector<map_value_type<Key, T>>, vector<Key>>;
+
+export template<typename Key, typename T, array_size_type<map_value_type<Key, T>> capacity>
+using static_split_linear_map = basic_split_linear_map<static_vector<map_value_type<Key, T>, capacity>, static_vector<Key, capacity>>;
+
+} // namespace containers
+
+using namespace bounded::literal;
+
+using non_copyable_map = containers::split_linear_map<int, bounded_test::non_copyable_integer>;
+
+static_assert(containers_test::test_reserve_and_capacity<non_copyable_map>());
+static_assert(containers_test::test_associative_container<non_copyable_map>());
+
+// Enough keys of each size for several blocks and a partial block at the end
+template<typename Key>
+constexpr auto test_many_keys() -> bool {
+	using map_type = containers::split_linear_map<Key, int>;
+	constexpr auto count = 150;
+	auto map = map_type();
+	for (auto n = 0; n != count; ++n) {
+		map.lazy_insert(static_cast<Key>(n * 3), bounded::value_to_function(n));
+	}
+	for (auto n = 0; n != count * 3; ++n) {
+		auto const found = containers::lookup(map, static_cast<Key>(n));
+		BOUNDED_ASSERT(n % 3 == 0 ? found and *found == n / 3 : !found);
+	}
+	map.erase(map.find(static_cast<Key>(0)));
+	map.erase(map.find(static_cast<Key>(300)), map.find(static_cast<Key>(330)));
+	BOUNDED_ASSERT(containers::size(map) == bounded::constant<count - 11>);
+	BOUNDED_ASSERT(!containers::lookup(map, static_cast<Key>(0)));
+	BOUNDED_ASSERT(!containers::lookup(map, static_cast<Key>(303)));
+	BOUNDED_ASSERT(*containers::lookup(map, static_cast<Key>(330)) == 110);
+	BOUNDED_ASSERT(*containers::lookup(map, static_cast<Key>(447)) == 149);
+	return true;
+}
+
+static_assert(test_many_keys<std::int16_t>());
+static_assert(test_many_keys<std::uint32_t>());
+static_assert(test_many_keys<std::int64_t>());
@@ -0,0 +1,200 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <std_module/prelude.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+import containers.algorithms.sort.external_sort;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.generate;
+import containers.begin_end;
+import containers.data;
+import containers.legacy_iterator;
+import containers.size;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace {
+
+using namespace bounded::literal;
+
+struct record {
+	std::uint32_t key;
+	std::array<std::uint32_t, 7> payload;
+
+	friend auto operator==(record const &, record const &) -> bool = default;
+};
+
+constexpr auto get_key = [](record const & value) {
+	return value.key;
+};
+
+auto random_records(auto const size) {
+	auto engine = std::mt19937(5678);
+	auto distribution = std::uniform_int_distribution<std::uint32_t>(0, 1000);
+	return containers::vector<record>(containers::generate_n(size, [&] {
+		auto const key = distribution(engine);
+		return record{key, {key, key + 1, key + 2, key + 3, key + 4, key + 5, key + 6}};
+	}));
+}
+
+auto as_span(auto const & values) {
+	return std::span(containers::data(values), static_cast<std::size_t>(containers::size(values)));
+}
+
+auto sorted_keys(auto values) {
+	std::sort(
+		containers::make_legacy_iterator(containers::begin(values)),
+		containers::make_legacy_iterator(containers::end(values)),
+		[](record const & lhs, record const & rhs) { return lhs.key < rhs.key; }
+	);
+	return values;
+}
+
+auto read_file(std::filesystem::path const & path) {
+	auto file = std::ifstream(path, std::ios::binary);
+	auto result = std::vector<record>(static_cast<std::size_t>(std::filesystem::file_size(path)) / sizeof(record));
+	file.read(reinterpret_cast<char *>(result.data()), static_cast<std::streamsize>(result.size() * sizeof(record)));
+	return result;
+}
+
+auto write_file(std::filesystem::path const & path, std::span<record const> const values) {
+	auto file = std::ofstream(path, std::ios::binary);
+	file.write(reinterpret_cast<char const *>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+}
+
+auto matches(std::vector<record> const & actual, auto const & expected) -> bool {
+	if (actual.size() != static_cast<std::size_t>(containers::size(expected))) {
+		return false;
+	}
+	auto const expected_span = as_span(expected);
+	for (std::size_t index = 0; index != actual.size(); ++index) {
+		// The payload moves with its record, but equal keys are in any order
+		if (actual[index].key != expected_span[index].key or actual[index].payload[0] != actual[index].key) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Deletes everything the test creates, even if it fails
+struct test_directory {
+	test_directory():
+		path(std::filesystem::temp_directory_path() / ("containers_external_sort_test_" + std::to_string(std::random_device()())))
+	{
+		std::filesystem::create_directories(path);
+	}
+	~test_directory() {
+		std::filesystem::remove_all(path);
+	}
+	auto is_empty_except(std::filesystem::path const & expected) const -> bool {
+		for (auto const & entry : std::filesystem::directory_iterator(path)) {
+			if (entry.path() != expected) {
+				return false;
+			}
+		}
+		return true;
+	}
+	std::filesystem::path path;
+};
+
+TEST_CASE("external_sort single run", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const values = random_records(1000_bi);
+	auto const output = directory.path / "output";
+	containers::external_sort<record>(as_span(values), output, get_key, {.memory_limit = 1U << 20U, .temporary_directory = directory.path});
+	CHECK(matches(read_file(output), sorted_keys(values)));
+	CHECK(directory.is_empty_except(output));
+}
+
+TEST_CASE("external_sort many runs", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const values = random_records(100'000_bi);
+	auto const output = directory.path / "output";
+	// Four runs, few enough to merge in one pass
+	containers::external_sort<record>(as_span(values), output, get_key, {.memory_limit = 1U << 20U, .temporary_directory = directory.path});
+	CHECK(matches(read_file(output), sorted_keys(values)));
+	CHECK(directory.is_empty_except(output));
+}
+
+TEST_CASE("external_sort multiple merge passes", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const values = random_records(5'000_bi);
+	auto const input = directory.path / "input";
+	auto const output = directory.path / "output";
+	write_file(input, as_span(values));
+	// Runs of 10 records, merged at most two at a time
+	containers::external_sort<record>(input, output, get_key, {.memory_limit = 10U * sizeof(record), .temporary_directory = directory.path});
+	CHECK(matches(read_file(output), sorted_keys(values)));
+	CHECK(read_file(input).size() == 5'000U);
+	CHECK(std::filesystem::exists(input));
+	std::filesystem::remove(input);
+	CHECK(directory.is_empty_except(output));
+}
+
+TEST_CASE("external_sort input is a multiple of the memory limit", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const values = random_records(100_bi);
+	auto const output = directory.path / "output";
+	containers::external_sort<record>(as_span(values), output, get_key, {.memory_limit = 50U * sizeof(record), .temporary_directory = directory.path});
+	CHECK(matches(read_file(output), sorted_keys(values)));
+}
+
+TEST_CASE("external_sort empty input", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const output = directory.path / "output";
+	containers::external_sort<record>(std::span<record const>(), output, get_key, {.memory_limit = 1024U, .temporary_directory = directory.path});
+	CHECK(std::filesystem::file_size(output) == 0U);
+}
+
+TEST_CASE("external_sort default key", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const values = containers::vector<std::int32_t>({5, -3, 1000000, 0, -7, 5, 2});
+	auto const output = directory.path / "output";
+	containers::external_sort<std::int32_t>(as_span(values), output, {.memory_limit = 2U * sizeof(std::int32_t), .temporary_directory = directory.path});
+	auto file = std::ifstream(output, std::ios::binary);
+	auto result = std::array<std::int32_t, 7>();
+	file.read(reinterpret_cast<char *>(result.data()), sizeof(result));
+	CHECK(result == std::array<std::int32_t, 7>({-7, -3, 0, 2, 5, 5, 1000000}));
+}
+
+// Each run is sorted by the radix key, so the merge has to use the same order.
+// That puts -0.0 before 0.0 and NaN at an end, where `<` would not.
+TEST_CASE("external_sort floating-point keys", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const nan = std::numeric_limits<double>::quiet_NaN();
+	auto const values = containers::vector<double>({0.0, nan, -1.5, -0.0, 2.0, nan, 0.0, -0.0, -nan, 1.0, -3.0, -0.0});
+	auto const output = directory.path / "output";
+	auto const identity = [](double const value) { return value; };
+	containers::external_sort<double>(as_span(values), output, identity, {.memory_limit = 2U * sizeof(double), .temporary_directory = directory.path});
+	auto expected = std::vector<std::uint64_t>();
+	for (auto const value : values) {
+		expected.push_back(containers::to_radix_sort_key(value));
+	}
+	std::sort(expected.begin(), expected.end());
+	auto file = std::ifstream(output, std::ios::binary);
+	auto result = std::array<double, 12>();
+	file.read(reinterpret_cast<char *>(result.data()), sizeof(result));
+	auto actual = std::vector<std::uint64_t>();
+	for (auto const value : result) {
+		actual.push_back(containers::to_radix_sort_key(value));
+	}
+	CHECK(actual == expected);
+}
+
+TEST_CASE("external_sort rejects a partial record", "[external_sort]") {
+	auto const directory = test_directory();
+	auto const input = directory.path / "input";
+	{
+		auto file = std::ofstream(input, std::ios::binary);
+		file.write("abcdef", 6);
+	}
+	CHECK_THROWS(containers::external_sort<std::uint32_t>(input, directory.path / "output", {.memory_limit = 1024U, .temporary_directory = directory.path}));
+}
+
+} // namespace
@@ -0,0 +1,88 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.test.lsd_radix_sort;
+
+import containers.algorithms.sort.lsd_radix_sort;
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.array;
+import containers.size;
+
+import bounded;
+import std_module;
+
+using namespace bounded::literal;
+using namespace containers_test;
+
+template<typename Container>
+constexpr auto test_lsd_radix_sort(sort_test_data<Container> data, auto function) {
+	auto buffer = Container();
+	BOUNDED_ASSERT(containers::size(buffer) == containers::size(data.input));
+	bool const data_in_buffer = containers::lsd_radix_sort(data.input, buffer, std::move(function));
+	auto const & sorted = data_in_buffer ? buffer : data.input;
+	BOUNDED_ASSERT(sorted == data.expected);
+	return true;
+}
+
+constexpr auto test_lsd_radix_sort(auto data) {
+	test_lsd_radix_sort(std::move(data), containers::to_radix_sort_key);
+	return true;
+}
+
+constexpr auto test_lsd_radix_sort_all(auto range) {
+	for (auto & data : range) {
+		test_lsd_radix_sort(std::move(data));
+	}
+	return true;
+}
+
+static_assert(test_lsd_radix_sort_all(uint8_0));
+static_assert(test_lsd_radix_sort_all(uint8_1));
+static_assert(test_lsd_radix_sort_all(uint8_2));
+static_assert(test_lsd_radix_sort_all(uint8_3));
+static_assert(test_lsd_radix_sort(uint8_many));
+static_assert(test_lsd_radix_sort(uint8_256));
+
+static_assert(test_lsd_radix_sort(uint16_many));
+static_assert(test_lsd_radix_sort(uint32_many));
+static_assert(test_lsd_radix_sort(uint64_many));
+
+static_assert(test_lsd_radix_sort(make_move_only(), default_copy));
+
+// Only the lowest byte differs, so only one pass is needed
+static_assert([] {
+	using array = containers::array<std::uint64_t, 4_bi>;
+	auto input = array{5, 255, 0, 17};
+	auto buffer = array();
+	BOUNDED_ASSERT(containers::lsd_radix_sort(input, buffer));
+	BOUNDED_ASSERT(buffer == array{0, 5, 17, 255});
+	return true;
+}());
+
+// Every byte is the same, so nothing needs to move
+static_assert([] {
+	using array = containers::array<std::uint32_t, 3_bi>;
+	auto input = array{7, 7, 7};
+	auto buffer = array();
+	BOUNDED_ASSERT(!containers::lsd_radix_sort(input, buffer));
+	BOUNDED_ASSERT(input == array{7, 7, 7});
+	return true;
+}());
+
+// Bytes 0 and 2 differ, so two passes bring the result back to the input
+static_assert([] {
+	using array = containers::array<std::uint32_t, 4_bi>;
+	auto input = array{0x30002, 0x10001, 0x30001, 0x20002};
+	auto buffer = array();
+	BOUNDED_ASSERT(!containers::lsd_radix_sort(input, buffer));
+	BOUNDED_ASSERT(input == array{0x10001, 0x20002, 0x30001, 0x30002});
+	return true;
+}());
@@ -13,7 +13,9 @@ import containers.algorithms.keyed_insert;
 import containers.begin_end;
 import containers.emplace_back;
 import containers.extract_key_to_less;
+import containers.eytzinger_map;
 import containers.flat_map;
+import containers.hash_map;
 import containers.map_value_type;
 import containers.size;
 import containers.vector;
@@ -84,6 +86,22 @@ using extract_key_t = Extract;
 		map.insert(OPERATORS_FORWARD(range));
 	}
 
+#elif defined USE_HASH_MAP
+	template<typename Key, typename Value, typename Extract>
+	using map_type = containers::hash_map<Key, Value, extract_key_t<Extract>>;
+
+	template<typename Key, typename Value>
+	using value_type = containers::map_value_type<Key, Value>;
+
+	template<typename Map>
+	auto construct_from_range(auto && range) {
+		return Map(OPERATORS_FORWARD(range));
+	}
+
+	void insert_range(auto & map, auto && range) {
+		map.insert(OPERATORS_FORWARD(range));
+	}
+
 #else
 	#error
 #endif
@@ -231,6 +249,43 @@ void test_performance(std::size_t const loop_count) {
 	destructor.set();
 }
 
+#if defined USE_FLAT_MAP
+// Times only `find`, on maps that are built once and then searched, to compare
+// the binary search of `flat_map` with the Eytzinger layout of
+// `eytzinger_map`. The keys are searched in random order, so that the lookups
+// do not find each other's cache lines.
+template<std::size_t key_size, std::size_t value_size>
+void test_lookup_performance(std::size_t const loop_count) {
+	static std::mt19937 engine(0);
+	std::uniform_int_distribution<std::uint32_t> distribution;
+	using container_type = containers::vector<value_type<Thing<key_size>, Thing<value_size>>>;
+	auto source = container_type();
+	source.reserve(bounded::check_in_range<containers::range_size_t<container_type>>(bounded::integer(loop_count)));
+	auto keys = std::vector<std::uint32_t>();
+	for (std::size_t n = 0; n != loop_count; ++n) {
+		auto const key = distribution(engine);
+		::containers::emplace_back(source, key, distribution(engine));
+		keys.push_back(key);
+	}
+	std::shuffle(keys.begin(), keys.end(), engine);
+
+	auto const binary_search_map = construct_from_range<map_type<Thing<key_size>, Thing<value_size>, Extract>>(source);
+	auto const eytzinger_map = containers::eytzinger_map<Thing<key_size>, Thing<value_size>, extract_key_t<Extract>>(source);
+
+	auto time_find = [&](auto const & map) {
+		auto const start = std::chrono::high_resolution_clock::now();
+		for (auto const key : keys) {
+			auto const volatile it [[maybe_unused]] = map.find(Thing<key_size>(key));
+		}
+		return std::chrono::duration_cast<unit>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+
+	std::cout << '\n';
+	std::cout << "Binary search found time: " << time_find(binary_search_map) << '\n';
+	std::cout << "Eytzinger found time: " << time_find(eytzinger_map) << '\n';
+}
+#endif
+
 } // namespace
 
 int main(int argc, char ** argv) {
@@ -242,4 +297,8 @@ int main(int argc, char ** argv) {
 
 	std::cout << "Testing performance.\n" << std::flush;
 	test_performance<1, 1>(loop_count);
+	#if defined USE_FLAT_MAP
+		test_lookup_performance<1, 1>(loop_count);
+		test_lookup_performance<4, 50>(loop_count);
+	#endif
 }
@@ -0,0 +1,102 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <std_module/prelude.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+import containers.algorithms.sort.sort;
+
+import containers.algorithms.generate;
+import containers.algorithms.parallel_for_each_index;
+import containers.begin_end;
+import containers.legacy_iterator;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace {
+
+using namespace bounded::literal;
+
+auto random_values(auto const size) {
+	auto engine = std::mt19937_64(1234);
+	// A small range of values so that there are many equal elements
+	auto distribution = std::uniform_int_distribution<int>(0, 1000);
+	return containers::vector<int>(containers::generate_n(size, [&] { return distribution(engine); }));
+}
+
+auto matches_std_sort(auto to_sort, auto const compare, containers::thread_count_t const threads) -> bool {
+	auto expected = to_sort;
+	std::sort(
+		containers::make_legacy_iterator(containers::begin(expected)),
+		containers::make_legacy_iterator(containers::end(expected)),
+		compare
+	);
+	containers::new_sort(to_sort, compare, threads);
+	return to_sort == expected;
+}
+
+auto make_values(auto const size, auto function) {
+	auto index = 0;
+	return containers::vector<int>(containers::generate_n(size, [&] {
+		auto const result = function(index);
+		++index;
+		return result;
+	}));
+}
+
+TEST_CASE("new_sort input patterns", "[new_sort]") {
+	constexpr auto size = 100'000_bi;
+	constexpr auto n = 100'000;
+	auto const patterns = std::initializer_list<containers::vector<int>>{
+		make_values(size, [](int const i) { return i; }),
+		make_values(size, [](int const i) { return n - i; }),
+		make_values(size, [](int) { return 0; }),
+		make_values(size, [](int const i) { return i % 4; }),
+		make_values(size, [](int const i) { return i < n / 2 ? i : n - i; }),
+		make_values(size, [](int const i) { return i % 1000; }),
+		make_values(size, [](int const i) { return (i + 1) % n; }),
+		make_values(size, [](int const i) { return i % 10'000 == 0 ? n - i : i; }),
+		random_values(size),
+	};
+	for (auto const & values : patterns) {
+		CHECK(matches_std_sort(values, std::less(), 1_bi));
+		CHECK(matches_std_sort(values, std::greater(), 1_bi));
+		CHECK(matches_std_sort(values, std::less(), 4_bi));
+	}
+}
+
+TEST_CASE("parallel new_sort", "[new_sort]") {
+	auto const values = random_values(300'000_bi);
+	for (auto const threads : std::initializer_list<containers::thread_count_t>{1_bi, 2_bi, 3_bi, 8_bi}) {
+		CHECK(matches_std_sort(values, std::less(), threads));
+		CHECK(matches_std_sort(values, std::greater(), threads));
+	}
+}
+
+// Large enough that the patterns are seen before the range is split
+TEST_CASE("parallel new_sort input patterns", "[new_sort]") {
+	constexpr auto size = 300'000_bi;
+	constexpr auto n = 300'000;
+	auto const patterns = std::initializer_list<containers::vector<int>>{
+		make_values(size, [](int const i) { return i; }),
+		make_values(size, [](int const i) { return n - i; }),
+		make_values(size, [](int) { return 0; }),
+		make_values(size, [](int const i) { return i % 4; }),
+		make_values(size, [](int const i) { return i < n / 2 ? i : n - i; }),
+	};
+	for (auto const & values : patterns) {
+		CHECK(matches_std_sort(values, std::less(), 4_bi));
+	}
+}
+
+TEST_CASE("parallel new_sort small input", "[new_sort]") {
+	auto values = containers::vector<int>({5, 3, -1, 4, 3});
+	containers::new_sort(values, std::less(), containers::thread_count_t(4_bi));
+	CHECK(values == containers::vector<int>({-1, 3, 3, 4, 5}));
+}
+
+} // namespace
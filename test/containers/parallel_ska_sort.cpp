@@ -0,0 +1,104 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <std_module/prelude.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+import containers.algorithms.sort.is_sorted;
+import containers.algorithms.sort.parallel_ska_sort;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.compare;
+import containers.algorithms.generate;
+import containers.algorithms.parallel_for_each_index;
+import containers.algorithms.transform;
+import containers.begin_end;
+import containers.legacy_iterator;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace {
+
+using namespace bounded::literal;
+
+template<typename T>
+auto random_values(auto const size) {
+	auto engine = std::mt19937_64(1234);
+	auto distribution = std::uniform_int_distribution<T>();
+	return containers::vector<T>(containers::generate_n(size, [&] { return distribution(engine); }));
+}
+
+auto matches_std_sort(auto to_sort, auto const & extract_key, containers::thread_count_t const threads) -> bool {
+	auto expected = to_sort;
+	std::stable_sort(
+		containers::make_legacy_iterator(containers::begin(expected)),
+		containers::make_legacy_iterator(containers::end(expected)),
+		[&](auto const & lhs, auto const & rhs) { return extract_key(lhs) < extract_key(rhs); }
+	);
+	containers::parallel_ska_sort(to_sort, extract_key, threads);
+	return containers::equal(
+		containers::transform(to_sort, extract_key),
+		containers::transform(expected, extract_key)
+	);
+}
+
+TEST_CASE("parallel_ska_sort large input", "[parallel_ska_sort]") {
+	auto const values = random_values<std::uint32_t>(200'000_bi);
+	for (auto const threads : std::initializer_list<containers::thread_count_t>{1_bi, 2_bi, 4_bi, 7_bi}) {
+		CHECK(matches_std_sort(values, containers::to_radix_sort_key, threads));
+	}
+}
+
+TEST_CASE("parallel_ska_sort signed keys", "[parallel_ska_sort]") {
+	auto const values = random_values<std::int64_t>(100'000_bi);
+	CHECK(matches_std_sort(values, containers::to_radix_sort_key, containers::thread_count_t(4_bi)));
+}
+
+TEST_CASE("parallel_ska_sort custom key", "[parallel_ska_sort]") {
+	auto const values = random_values<std::uint64_t>(100'000_bi);
+	auto const low_bits = [](std::uint64_t const value) { return static_cast<std::uint16_t>(value); };
+	CHECK(matches_std_sort(values, low_bits, containers::thread_count_t(3_bi)));
+}
+
+TEST_CASE("parallel_ska_sort keys with equal high bytes", "[parallel_ska_sort]") {
+	auto const values = random_values<std::uint64_t>(100'000_bi);
+	auto const small = [](std::uint64_t const value) { return value % 50'000U; };
+	CHECK(matches_std_sort(values, small, containers::thread_count_t(4_bi)));
+	auto const high_bits = [](std::uint64_t const value) { return value | 0xFFFF'FFFF'0000'0000U; };
+	CHECK(matches_std_sort(values, high_bits, containers::thread_count_t(4_bi)));
+}
+
+TEST_CASE("parallel_ska_sort equal keys", "[parallel_ska_sort]") {
+	auto const values = random_values<std::uint64_t>(100'000_bi);
+	auto const constant = [](std::uint64_t) { return std::uint32_t(7); };
+	CHECK(matches_std_sort(values, constant, containers::thread_count_t(4_bi)));
+}
+
+TEST_CASE("parallel_ska_sort exception", "[parallel_ska_sort]") {
+	auto values = random_values<std::uint32_t>(200'000_bi);
+	auto const throw_on_last = [&](std::uint32_t const & value) {
+		if (&value == &values[199'999_bi]) {
+			throw std::runtime_error("extract_key");
+		}
+		return value;
+	};
+	CHECK_THROWS_AS(containers::parallel_ska_sort(values, throw_on_last, containers::thread_count_t(4_bi)), std::runtime_error);
+}
+
+TEST_CASE("parallel_ska_sort small input", "[parallel_ska_sort]") {
+	auto values = containers::vector<int>({5, 3, -1, 4, 3});
+	containers::parallel_ska_sort(values);
+	CHECK(values == containers::vector<int>({-1, 3, 3, 4, 5}));
+}
+
+TEST_CASE("parallel_ska_sort non-numeric key", "[parallel_ska_sort]") {
+	auto values = containers::vector<std::tuple<int, int>>({{2, 1}, {1, 2}, {1, 1}});
+	containers::parallel_ska_sort(values);
+	CHECK(values == containers::vector<std::tuple<int, int>>({{1, 1}, {1, 2}, {2, 1}}));
+}
+
+} // namespace
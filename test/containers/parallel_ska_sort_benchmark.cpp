@@ -0,0 +1,73 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <std_module/prelude.hpp>
+#include <benchmark/benchmark.h>
+
+import bounded;
+import containers;
+import std_module;
+
+namespace {
+
+using namespace bounded::literal;
+
+// https://github.com/google/benchmark/issues/1584
+auto DoNotOptimize(auto && value) -> void {
+	benchmark::DoNotOptimize(value);
+}
+
+template<typename T>
+auto create_data(benchmark::State const & state) {
+	auto engine = std::mt19937_64(77342348);
+	auto distribution = std::uniform_int_distribution<T>();
+	using container_t = containers::vector<T>;
+	auto const size = bounded::assume_in_range<containers::range_size_t<container_t>>(state.range(0));
+	return container_t(containers::generate_n(size, [&] { return distribution(engine); }));
+}
+
+auto get_thread_count(benchmark::State const & state) {
+	return bounded::assume_in_range<containers::thread_count_t>(state.range(1));
+}
+
+// Argument 0 is the number of elements, argument 1 is the number of threads
+template<typename T>
+auto benchmark_parallel_ska_sort(benchmark::State & state) -> void {
+	auto const original = create_data<T>(state);
+	auto const threads = get_thread_count(state);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto to_sort = original;
+		DoNotOptimize(containers::data(to_sort));
+		state.ResumeTiming();
+		containers::parallel_ska_sort(to_sort, containers::to_radix_sort_key, threads);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename T>
+auto benchmark_ska_sort(benchmark::State & state) -> void {
+	auto const original = create_data<T>(state);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto to_sort = original;
+		DoNotOptimize(containers::data(to_sort));
+		state.ResumeTiming();
+		containers::ska_sort(to_sort);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define PARALLEL_SIZES() ArgsProduct({{1 << 16, 1 << 20, 1 << 24, 1 << 26}, {1, 2, 4, 8, 16, 32}})
+#define SERIAL_SIZES() Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24)->Arg(1 << 26)
+
+BENCHMARK(benchmark_ska_sort<std::uint32_t>)->SERIAL_SIZES()->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_parallel_ska_sort<std::uint32_t>)->PARALLEL_SIZES()->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_ska_sort<std::uint64_t>)->SERIAL_SIZES()->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_parallel_ska_sort<std::uint64_t>)->PARALLEL_SIZES()->UseRealTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
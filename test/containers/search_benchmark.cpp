@@ -0,0 +1,99 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <std_module/prelude.hpp>
+#include <benchmark/benchmark.h>
+
+import bounded;
+import containers;
+import std_module;
+
+namespace {
+
+using namespace bounded::literal;
+
+// https://github.com/google/benchmark/issues/1584
+auto DoNotOptimize(auto && value) -> void {
+	benchmark::DoNotOptimize(value);
+}
+
+using key_type = std::uint64_t;
+using keys_t = containers::vector<key_type>;
+
+// The gap between each key and the next is the same on average
+auto uniform_keys(std::mt19937_64 & engine, std::size_t const size) -> keys_t {
+	auto gap_distribution = std::uniform_int_distribution<key_type>(1, 64);
+	auto key = key_type(0);
+	return keys_t(containers::generate_n(bounded::assume_in_range<containers::range_size_t<keys_t>>(size), [&] {
+		key += gap_distribution(engine);
+		return key;
+	}));
+}
+
+// The gaps follow a Zipf-like power law: most are small, but a few are large
+// enough to hold most of the range of keys
+auto zipf_keys(std::mt19937_64 & engine, std::size_t const size) -> keys_t {
+	auto uniform = std::uniform_real_distribution<double>(0.0, 1.0);
+	auto key = key_type(0);
+	return keys_t(containers::generate_n(bounded::assume_in_range<containers::range_size_t<keys_t>>(size), [&] {
+		auto const gap = std::min(1.0 / (1.0 - uniform(engine)), 1e9);
+		key += static_cast<key_type>(gap);
+		return key;
+	}));
+}
+
+// Half of the searches are for keys that are present, and the rest are for
+// one more than a key that is present
+auto search_keys(std::mt19937_64 & engine, keys_t const & keys) -> keys_t {
+	auto index_distribution = std::uniform_int_distribution<std::size_t>(0, static_cast<std::size_t>(containers::size(keys)) - 1U);
+	auto coin = std::bernoulli_distribution();
+	auto const data = containers::data(keys);
+	return keys_t(containers::generate_n(1'024_bi, [&] {
+		auto const key = data[index_distribution(engine)];
+		return coin(engine) ? key : key + 1U;
+	}));
+}
+
+auto benchmark_impl(benchmark::State & state, auto make_keys, auto search) -> void {
+	auto engine = std::mt19937_64(std::random_device()());
+	auto const keys = make_keys(engine, static_cast<std::size_t>(state.range(0)));
+	auto const searched = search_keys(engine, keys);
+	for (auto _ : state) {
+		for (auto const key : searched) {
+			DoNotOptimize(search(keys, key));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(containers::size(searched)));
+}
+
+constexpr auto binary = [](keys_t const & keys, key_type const key) {
+	return containers::lower_bound(keys, key);
+};
+constexpr auto interpolation = [](keys_t const & keys, key_type const key) {
+	return containers::interpolation_lower_bound(keys, key);
+};
+
+auto benchmark_uniform_binary(benchmark::State & state) -> void {
+	benchmark_impl(state, uniform_keys, binary);
+}
+auto benchmark_uniform_interpolation(benchmark::State & state) -> void {
+	benchmark_impl(state, uniform_keys, interpolation);
+}
+auto benchmark_zipf_binary(benchmark::State & state) -> void {
+	benchmark_impl(state, zipf_keys, binary);
+}
+auto benchmark_zipf_interpolation(benchmark::State & state) -> void {
+	benchmark_impl(state, zipf_keys, interpolation);
+}
+
+#define BENCHMARK_SEARCH(function) \
+	BENCHMARK(function)->RangeMultiplier(16)->Range(1 << 8, 1 << 24)
+
+BENCHMARK_SEARCH(benchmark_uniform_binary);
+BENCHMARK_SEARCH(benchmark_uniform_interpolation);
+BENCHMARK_SEARCH(benchmark_zipf_binary);
+BENCHMARK_SEARCH(benchmark_zipf_interpolation);
+
+} // namespace
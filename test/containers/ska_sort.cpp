@@ -15,6 +15,7 @@ export module containers.test.ska_sort;
 import containers.algorithms.sort.common_prefix;
 import containers.algorithms.sort.inplace_radix_sort;
 import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.sort_tuning;
 import containers.algorithms.sort.to_radix_sort_key;
 
 import containers.begin_end;
@@ -96,3 +97,19 @@ static_assert(test_sort(tuple_tuple));
 
 static_assert(test_sort(make_move_only(), default_copy));
 static_assert(test_sort(make_wrapper(), get_value_member));
+
+constexpr auto test_sort_tuned(auto data, containers::sort_tuning const tuning) {
+	containers::inplace_radix_sort(
+		containers::range_view(containers::begin(data.input), containers::end(data.input)),
+		containers::to_radix_sort_key,
+		tuning
+	);
+	return data.input == data.expected;
+}
+
+// Only comparison sorts, only american flag sort, and only ska_sort byte
+// partitioning
+static_assert(test_sort_tuned(uint32_many, containers::sort_tuning(1000, 2000)));
+static_assert(test_sort_tuned(uint32_many, containers::sort_tuning(0, 2000)));
+static_assert(test_sort_tuned(uint32_many, containers::sort_tuning(0, 0)));
+static_assert(test_sort_tuned(make_vector_vector(), containers::sort_tuning(0, 0)));
@@ -10,6 +10,7 @@
 #include <benchmark/benchmark.h>
 
 import containers.algorithms.sort.inplace_radix_sort;
+import containers.extract_key_to_less;
 
 import bounded;
 import containers;
@@ -81,6 +82,23 @@ void benchmark_double_buffered_ska_sort(benchmark::State & state, auto create) {
 	}
 }
 
+void benchmark_lsd_radix_sort(benchmark::State & state, auto create) {
+	auto randomness = std::mt19937_64(77342348);
+	auto buffer = create(randomness, get_value(state));
+	for (auto _ : state) {
+		auto to_sort = create(randomness, get_value(state));
+		using containers::data;
+		DoNotOptimize(data(to_sort));
+		DoNotOptimize(data(buffer));
+		bool which = containers::lsd_radix_sort(to_sort, buffer);
+		if (which)
+			assert(containers::is_sorted(buffer));
+		else
+			assert(containers::is_sorted(to_sort));
+		benchmark::ClobberMemory();
+	}
+}
+
 void benchmark_std_sort(benchmark::State & state, auto create) {
 	auto randomness = std::mt19937_64(77342348);
 	create(randomness, get_value(state));
@@ -97,6 +115,34 @@ void benchmark_std_sort(benchmark::State & state, auto create) {
 	}
 }
 
+void benchmark_std_stable_sort(benchmark::State & state, auto create) {
+	auto randomness = std::mt19937_64(77342348);
+	create(randomness, get_value(state));
+	for (auto _ : state) {
+		auto to_sort = create(randomness, get_value(state));
+		DoNotOptimize(containers::data(to_sort));
+		std::stable_sort(
+			containers::make_legacy_iterator(containers::begin(to_sort)),
+			containers::make_legacy_iterator(containers::end(to_sort)),
+			containers::extract_key_to_less(containers::to_radix_sort_key)
+		);
+		assert(containers::is_sorted(to_sort));
+		benchmark::ClobberMemory();
+	}
+}
+
+void benchmark_stable_ska_sort(benchmark::State & state, auto create) {
+	auto randomness = std::mt19937_64(77342348);
+	create(randomness, get_value(state));
+	for (auto _ : state) {
+		auto to_sort = create(randomness, get_value(state));
+		DoNotOptimize(containers::data(to_sort));
+		containers::stable_ska_sort(to_sort);
+		assert(containers::is_sorted(to_sort));
+		benchmark::ClobberMemory();
+	}
+}
+
 void american_flag_sort(range auto && to_sort, auto && extract_key) {
 	inplace_radix_sort<0, numeric_traits::max_value<std::ptrdiff_t>>(
 		containers::range_view(
@@ -143,6 +189,76 @@ void benchmark_ska_sort(benchmark::State & state, auto create) {
 	}
 }
 
+// A key that has to be computed, like a hash or an indirect lookup. ska_sort
+// caches keys from extractors marked as expensive and calls hashed_key once
+// per element.
+struct hashed_key {
+	static constexpr auto operator()(std::uint64_t value) -> std::uint64_t {
+		value ^= value >> 33U;
+		value *= 0xff51afd7ed558ccdU;
+		value ^= value >> 33U;
+		value *= 0xc4ceb9fe1a85ec53U;
+		value ^= value >> 33U;
+		return value;
+	}
+};
+
+} // namespace
+
+template<>
+constexpr auto containers::is_expensive_key_extractor<hashed_key> = true;
+
+namespace {
+
+void benchmark_computed_key(benchmark::State & state, auto sort) {
+	auto randomness = std::mt19937_64(77342348);
+	for (auto _ : state) {
+		auto to_sort = create_radix_sort_data(randomness, get_value(state), std::uniform_int_distribution<std::uint64_t>());
+		DoNotOptimize(containers::data(to_sort));
+		sort(to_sort, hashed_key());
+		assert(containers::is_sorted(to_sort, containers::extract_key_to_less(hashed_key())));
+		benchmark::ClobberMemory();
+	}
+}
+
+// A record large enough that moving it through every radix pass costs more
+// than sorting the indexes and moving each record once
+struct large_record {
+	std::uint64_t key;
+	containers::array<std::uint64_t, 24_bi> payload;
+};
+
+struct get_record_key {
+	static constexpr auto operator()(large_record const & record) -> std::uint64_t {
+		return record.key;
+	}
+};
+
+void benchmark_large_record(benchmark::State & state, auto sort) {
+	auto randomness = std::mt19937_64(77342348);
+	auto distribution = std::uniform_int_distribution<std::uint64_t>();
+	for (auto _ : state) {
+		auto to_sort = containers::vector<large_record>(containers::generate_n(get_value(state), [&] {
+			return large_record{distribution(randomness), {}};
+		}));
+		DoNotOptimize(containers::data(to_sort));
+		sort(to_sort, get_record_key());
+		assert(containers::is_sorted(to_sort, containers::extract_key_to_less(get_record_key())));
+		benchmark::ClobberMemory();
+	}
+}
+
+void benchmark_string_sort(benchmark::State & state, auto create) {
+	auto randomness = std::mt19937_64(77342348);
+	for (auto _ : state) {
+		auto to_sort = create(randomness, get_value(state));
+		DoNotOptimize(containers::data(to_sort));
+		containers::string_sort(to_sort);
+		assert(containers::is_sorted(to_sort));
+		benchmark::ClobberMemory();
+	}
+}
+
 void benchmark_inplace_radix_sort(benchmark::State & state, auto create) {
 	auto randomness = std::mt19937_64(77342348);
 	create(randomness, get_value(state));
@@ -222,6 +338,8 @@ BENCHMARK(benchmark_limited_inplace_sort)->LIMITED_RANGE();
 		REGISTER_INDIVIDUAL_BENCHMARK("inplace_radix_sort_" name, benchmark_inplace_radix_sort, create); \
 		REGISTER_INDIVIDUAL_BENCHMARK("ska_sort_" name, benchmark_ska_sort, create); \
 		REGISTER_INDIVIDUAL_BENCHMARK("std_sort_" name, benchmark_std_sort, create); \
+		REGISTER_INDIVIDUAL_BENCHMARK("stable_ska_sort_" name, benchmark_stable_ska_sort, create); \
+		REGISTER_INDIVIDUAL_BENCHMARK("std_stable_sort_" name, benchmark_std_stable_sort, create); \
 	} while (false)
 
 #define REGISTER_BENCHMARK(name, create) \
@@ -230,6 +348,12 @@ BENCHMARK(benchmark_limited_inplace_sort)->LIMITED_RANGE();
 		REGISTER_INDIVIDUAL_BENCHMARK("double_buffered_ska_sort_" name, benchmark_double_buffered_ska_sort, create); \
 	} while (false)
 
+#define REGISTER_NUMERIC_BENCHMARK(name, create) \
+	do { \
+		REGISTER_BENCHMARK(name, create); \
+		REGISTER_INDIVIDUAL_BENCHMARK("lsd_radix_sort_" name, benchmark_lsd_radix_sort, create); \
+	} while (false)
+
 constexpr auto create_simple_data = [](auto distribution) {
 	return [=](auto & engine, bounded::bounded_integer auto const size) {
 		return create_radix_sort_data(engine, size, distribution);
@@ -255,6 +379,32 @@ constexpr auto create_range_data = [](bounded::bounded_integer auto const max_si
 	};
 };
 
+// Keys that look like URLs or log keys: a few hosts, so every key shares a long
+// prefix with many others, followed by a path and an id of varying length
+constexpr auto create_url_data = [](auto & engine, bounded::bounded_integer auto const size) {
+	constexpr auto hosts = std::array<std::string_view, 4>{
+		"https://www.example.com/",
+		"https://api.example.com/v2/users/",
+		"https://cdn.example.net/assets/images/",
+		"http://localhost:8080/",
+	};
+	constexpr auto paths = std::array<std::string_view, 4>{
+		"index.html?id=",
+		"profile/",
+		"search?q=",
+		"",
+	};
+	auto host_distribution = std::uniform_int_distribution<std::size_t>(0, hosts.size() - 1);
+	auto path_distribution = std::uniform_int_distribution<std::size_t>(0, paths.size() - 1);
+	auto id_distribution = std::uniform_int_distribution<std::uint32_t>();
+	return containers::vector<containers::string>(containers::generate_n(size, [&] {
+		auto url = std::string(hosts[host_distribution(engine)]);
+		url += paths[path_distribution(engine)];
+		url += std::to_string(id_distribution(engine));
+		return containers::string(std::string_view(url));
+	}));
+};
+
 using numeric_traits::min_value;
 using numeric_traits::max_value;
 
@@ -272,42 +422,56 @@ constexpr auto full_range_distribution() {
 }
 
 void register_all_benchmarks() {
+	REGISTER_INDIVIDUAL_BENCHMARK("computed_key_inplace_radix_sort", benchmark_computed_key, [](auto & to_sort, auto extract_key) { inplace_radix_sort(to_sort, extract_key); });
+	REGISTER_INDIVIDUAL_BENCHMARK("computed_key_ska_sort", benchmark_computed_key, containers::ska_sort);
+	REGISTER_INDIVIDUAL_BENCHMARK("large_record_ska_sort", benchmark_large_record, containers::ska_sort);
+	REGISTER_INDIVIDUAL_BENCHMARK("large_record_sort_permutation", benchmark_large_record, [](auto & to_sort, auto extract_key) {
+		containers::apply_permutation_inplace(to_sort, containers::sort_permutation(to_sort, extract_key));
+	});
 	REGISTER_BENCHMARK(
 		"bool",
 		create_simple_data(full_range_distribution<bool>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"uint8",
 		create_simple_data(full_range_distribution<std::uint8_t>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"int8",
 		create_simple_data(full_range_distribution<std::int8_t>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"uint16",
 		create_simple_data(full_range_distribution<std::uint16_t>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"int16",
 		create_simple_data(full_range_distribution<std::int16_t>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"uint32",
 		create_simple_data(full_range_distribution<std::uint32_t>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"int32",
 		create_simple_data(full_range_distribution<std::int32_t>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"uint64",
 		create_simple_data(full_range_distribution<std::uint64_t>())
 	);
-	REGISTER_BENCHMARK(
+	REGISTER_NUMERIC_BENCHMARK(
 		"int64",
 		create_simple_data(full_range_distribution<std::int64_t>())
 	);
+	REGISTER_NUMERIC_BENCHMARK(
+		"float",
+		create_simple_data(std::uniform_real_distribution<float>(-1.0e6F, 1.0e6F))
+	);
+	REGISTER_NUMERIC_BENCHMARK(
+		"uint64_low_bits",
+		create_simple_data(std::uniform_int_distribution<std::uint64_t>(0, 1'000'000))
+	);
 	REGISTER_BENCHMARK(
 		"tuple_uint8_uint8_uint8_uint8",
 		create_simple_data(
@@ -390,6 +554,8 @@ void register_all_benchmarks() {
 			return create_radix_sort_data<containers::string>(engine, size, char_distribution);
 		})
 	);
+	REGISTER_SOME_BENCHMARKS("url", create_url_data);
+	REGISTER_INDIVIDUAL_BENCHMARK("string_sort_url", benchmark_string_sort, create_url_data);
 	REGISTER_SOME_BENCHMARKS(
 		"vector_string",
 		create_range_data(10_bi, [](auto & engine, auto size) {
@@ -73,6 +73,13 @@ auto benchmark_standard(benchmark::State & state) -> void {
 	benchmark_impl<data_size>(state, containers::sort);
 }
 
+// Argument 0 is the number of elements, argument 1 is the number of threads
+template<std::size_t data_size>
+auto benchmark_parallel(benchmark::State & state) -> void {
+	auto const threads = bounded::assume_in_range<containers::thread_count_t>(state.range(1));
+	benchmark_impl<data_size>(state, [=](auto & range) { containers::new_sort(range, std::less(), threads); });
+}
+
 constexpr auto insertion_sort = [](containers::range auto && r) -> void {
 	auto const first = containers::begin(r);
 	auto const last = containers::end(r);
@@ -92,6 +99,189 @@ auto benchmark_insertion_sort(benchmark::State & state) -> void {
 	benchmark_impl<data_size>(state, insertion_sort);
 }
 
+template<typename T>
+auto benchmark_arithmetic_impl(benchmark::State & state, auto function) -> void {
+	auto engine = std::mt19937(std::random_device()());
+	auto value_distribution = std::uniform_int_distribution<std::int32_t>();
+	using container_t = containers::vector<T>;
+	using size_type = containers::range_size_t<container_t>;
+	auto const size = bounded::assume_in_range<size_type>(state.range(0));
+	auto container = container_t(containers::repeat_default_n<T>(size));
+
+	for (auto _ : state) {
+		for (auto & value : container) {
+			value = static_cast<T>(value_distribution(engine));
+		}
+		benchmark::DoNotOptimize(container);
+		benchmark::ClobberMemory();
+		function(container);
+		benchmark::DoNotOptimize(container);
+		benchmark::ClobberMemory();
+	}
+}
+
+template<typename T>
+auto benchmark_network_sort(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<T>(state, containers::network_sort);
+}
+
+template<typename T>
+auto benchmark_arithmetic_mine(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<T>(state, containers::new_sort);
+}
+
+template<typename T>
+auto benchmark_arithmetic_standard(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<T>(state, containers::sort);
+}
+
+#define BENCHMARK_ARITHMETIC(type) \
+	BENCHMARK(benchmark_network_sort<type>)->DenseRange(7, 8, 1)->Arg(12)->Arg(16)->Arg(25)->Arg(32); \
+	BENCHMARK(benchmark_arithmetic_mine<type>)->DenseRange(7, 8, 1)->Arg(12)->Arg(16)->Arg(25)->Arg(32); \
+	BENCHMARK(benchmark_arithmetic_standard<type>)->DenseRange(7, 8, 1)->Arg(12)->Arg(16)->Arg(25)->Arg(32)
+
+BENCHMARK_ARITHMETIC(std::int32_t);
+BENCHMARK_ARITHMETIC(std::uint32_t);
+BENCHMARK_ARITHMETIC(float);
+BENCHMARK_ARITHMETIC(std::int64_t);
+
+enum class input_pattern {
+	random,
+	sorted,
+	reverse_sorted,
+	few_unique,
+	organ_pipe,
+	sorted_with_noise,
+};
+
+// Argument 0 is the number of elements, argument 1 is the input_pattern
+auto benchmark_pattern_impl(benchmark::State & state, auto function) -> void {
+	auto engine = std::mt19937(std::random_device()());
+	auto value_distribution = std::uniform_int_distribution<std::int32_t>();
+	using container_t = containers::vector<std::int32_t>;
+	using size_type = containers::range_size_t<container_t>;
+	auto const size = bounded::assume_in_range<size_type>(state.range(0));
+	auto const pattern = static_cast<input_pattern>(state.range(1));
+	auto container = container_t(containers::repeat_default_n<std::int32_t>(size));
+
+	for (auto _ : state) {
+		auto index = std::int32_t(0);
+		auto const count = static_cast<std::int32_t>(size);
+		for (auto & value : container) {
+			switch (pattern) {
+				case input_pattern::random:
+					value = value_distribution(engine);
+					break;
+				case input_pattern::sorted:
+					value = index;
+					break;
+				case input_pattern::reverse_sorted:
+					value = count - index;
+					break;
+				case input_pattern::few_unique:
+					value = value_distribution(engine) % 16;
+					break;
+				case input_pattern::organ_pipe:
+					value = index < count / 2 ? index : count - index;
+					break;
+				case input_pattern::sorted_with_noise:
+					value = value_distribution(engine) % 100 == 0 ? value_distribution(engine) % count : index;
+					break;
+			}
+			++index;
+		}
+		benchmark::DoNotOptimize(container);
+		benchmark::ClobberMemory();
+		function(container);
+		benchmark::DoNotOptimize(container);
+		benchmark::ClobberMemory();
+	}
+}
+
+auto benchmark_pattern_mine(benchmark::State & state) -> void {
+	benchmark_pattern_impl(state, containers::new_sort);
+}
+
+auto benchmark_pattern_standard(benchmark::State & state) -> void {
+	benchmark_pattern_impl(state, containers::sort);
+}
+
+BENCHMARK(benchmark_pattern_mine)->ArgsProduct({{1 << 10, 1 << 16, 1 << 20}, benchmark::CreateDenseRange(0, 5, 1)});
+BENCHMARK(benchmark_pattern_standard)->ArgsProduct({{1 << 10, 1 << 16, 1 << 20}, benchmark::CreateDenseRange(0, 5, 1)});
+
+// Large enough that most of the time is spent partitioning. new_sort uses a
+// branchless block partition for these types.
+#define BENCHMARK_LARGE_ARITHMETIC(type) \
+	BENCHMARK(benchmark_arithmetic_mine<type>)->RangeMultiplier(8)->Range(1 << 10, 1 << 22); \
+	BENCHMARK(benchmark_arithmetic_standard<type>)->RangeMultiplier(8)->Range(1 << 10, 1 << 22)
+
+BENCHMARK_LARGE_ARITHMETIC(std::uint32_t);
+BENCHMARK_LARGE_ARITHMETIC(double);
+
+#define BENCHMARK_LARGE(data_size) \
+	BENCHMARK(benchmark_mine<data_size>)->RangeMultiplier(8)->Range(1 << 10, 1 << 22); \
+	BENCHMARK(benchmark_standard<data_size>)->RangeMultiplier(8)->Range(1 << 10, 1 << 22)
+
+BENCHMARK_LARGE(8);
+BENCHMARK_LARGE(16);
+
+// Selecting the median, and the top 1% for partial sorts
+auto selection_index(auto const & range) {
+	return containers::size(range) / 2_bi;
+}
+
+auto top_count(auto const & range) {
+	return containers::size(range) / 100_bi;
+}
+
+auto benchmark_nth_element_mine(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<std::uint32_t>(state, [](auto & range) {
+		containers::nth_element(range, selection_index(range));
+	});
+}
+
+auto benchmark_radix_select(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<std::uint32_t>(state, [](auto & range) {
+		containers::radix_select(range, selection_index(range));
+	});
+}
+
+auto benchmark_nth_element_standard(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<std::uint32_t>(state, [](auto & range) {
+		auto const first = containers::make_legacy_iterator(containers::begin(range));
+		std::nth_element(first, first + static_cast<std::ptrdiff_t>(selection_index(range)), containers::make_legacy_iterator(containers::end(range)));
+	});
+}
+
+auto benchmark_partial_sort_mine(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<std::uint32_t>(state, [](auto & range) {
+		containers::partial_sort(range, top_count(range));
+	});
+}
+
+auto benchmark_partial_ska_sort(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<std::uint32_t>(state, [](auto & range) {
+		containers::partial_ska_sort(range, top_count(range));
+	});
+}
+
+auto benchmark_partial_sort_standard(benchmark::State & state) -> void {
+	benchmark_arithmetic_impl<std::uint32_t>(state, [](auto & range) {
+		auto const first = containers::make_legacy_iterator(containers::begin(range));
+		std::partial_sort(first, first + static_cast<std::ptrdiff_t>(top_count(range)), containers::make_legacy_iterator(containers::end(range)));
+	});
+}
+
+#define BENCHMARK_SELECTION(function) \
+	BENCHMARK(function)->RangeMultiplier(8)->Range(1 << 10, 1 << 22)
+
+BENCHMARK_SELECTION(benchmark_nth_element_mine);
+BENCHMARK_SELECTION(benchmark_radix_select);
+BENCHMARK_SELECTION(benchmark_nth_element_standard);
+BENCHMARK_SELECTION(benchmark_partial_sort_mine);
+BENCHMARK_SELECTION(benchmark_partial_ska_sort);
+BENCHMARK_SELECTION(benchmark_partial_sort_standard);
+
 #define BENCHMARK_ALL(data_size) \
 	BENCHMARK(benchmark_insertion_sort<data_size>)->DenseRange(1, 5, 1)->Arg(16)->Arg(25)->Arg(64)->Arg(128); \
 	BENCHMARK(benchmark_chunked_insertion_sort<data_size>)->DenseRange(1, 5, 1)->Arg(16)->Arg(25)->Arg(64)->Arg(128); \
@@ -104,4 +294,10 @@ BENCHMARK_ALL(8);
 BENCHMARK_ALL(64);
 BENCHMARK_ALL(65);
 
+#define BENCHMARK_PARALLEL(data_size) \
+	BENCHMARK(benchmark_parallel<data_size>)->ArgsProduct({{1 << 16, 1 << 20, 1 << 23}, {1, 2, 4, 8, 16, 32}})->UseRealTime()->Unit(benchmark::kMillisecond)
+
+BENCHMARK_PARALLEL(4);
+BENCHMARK_PARALLEL(64);
+
 } // namespace
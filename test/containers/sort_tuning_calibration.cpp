@@ -0,0 +1,133 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Measures the radix sort thresholds that are fastest on this machine and
+// prints them as a tuning profile. One large random input goes through buckets
+// of every size as it is sorted, so the time to sort it reflects every
+// crossover at once. Each threshold is chosen in turn while holding the other
+// one fixed.
+//
+// Usage: sort_tuning_calibration [element count]
+
+#include <std_module/prelude.hpp>
+
+import containers.algorithms.sort.inplace_radix_sort;
+import containers.algorithms.sort.sort_tuning;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.algorithms.generate;
+import containers.begin_end;
+import containers.range_view;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace {
+
+constexpr auto std_sort_thresholds = std::array<std::ptrdiff_t, 7>{8, 16, 32, 64, 128, 256, 512};
+constexpr auto american_flag_sort_thresholds = std::array<std::ptrdiff_t, 7>{256, 512, 1024, 2048, 4096, 8192, 16384};
+constexpr auto repetitions = 5;
+
+template<typename T>
+auto random_input(std::size_t const size) {
+	auto engine = std::mt19937_64(std::random_device()());
+	auto distribution = std::uniform_int_distribution<std::uint64_t>();
+	return containers::vector<T>(containers::generate_n(
+		bounded::assume_in_range<bounded::integer<0, 1'000'000'000>>(size),
+		[&] {
+			if constexpr (std::same_as<T, std::tuple<std::uint64_t, std::uint64_t>>) {
+				return T(distribution(engine), distribution(engine));
+			} else {
+				return static_cast<T>(distribution(engine));
+			}
+		}
+	));
+}
+
+// The fastest of several runs, because anything else running on the machine
+// only ever makes a run slower
+template<typename T>
+auto seconds_to_sort(containers::vector<T> const & input, containers::sort_tuning const tuning) -> double {
+	auto best = std::numeric_limits<double>::infinity();
+	for (auto n = 0; n != repetitions; ++n) {
+		auto to_sort = input;
+		auto const start = std::chrono::steady_clock::now();
+		containers::inplace_radix_sort(
+			containers::range_view(containers::begin(to_sort), containers::end(to_sort)),
+			containers::to_radix_sort_key,
+			tuning
+		);
+		auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+auto calibrate(auto const & cost) -> containers::sort_tuning {
+	auto best = containers::sort_tuning();
+	auto choose = [&](std::ptrdiff_t containers::sort_tuning::* const threshold, auto const & candidates) {
+		auto best_cost = std::numeric_limits<double>::infinity();
+		auto best_value = best.*threshold;
+		for (auto const candidate : candidates) {
+			auto tuning = best;
+			tuning.*threshold = candidate;
+			if (tuning.std_sort_threshold >= tuning.american_flag_sort_threshold) {
+				continue;
+			}
+			auto const current_cost = cost(tuning);
+			if (current_cost < best_cost) {
+				best_cost = current_cost;
+				best_value = candidate;
+			}
+		}
+		best.*threshold = best_value;
+	};
+	choose(&containers::sort_tuning::std_sort_threshold, std_sort_thresholds);
+	choose(&containers::sort_tuning::american_flag_sort_threshold, american_flag_sort_thresholds);
+	choose(&containers::sort_tuning::std_sort_threshold, std_sort_thresholds);
+	return best;
+}
+
+auto print(std::string_view const name, containers::sort_tuning const tuning) -> void {
+	std::cout << name << ".std_sort_threshold = " << tuning.std_sort_threshold << '\n';
+	std::cout << name << ".american_flag_sort_threshold = " << tuning.american_flag_sort_threshold << '\n';
+}
+
+template<typename T>
+auto calibrate_type(std::string_view const name, std::size_t const size) {
+	auto const input = random_input<T>(size);
+	auto const baseline = seconds_to_sort(input, containers::sort_tuning());
+	auto const tuning = calibrate([&](containers::sort_tuning const candidate) {
+		return seconds_to_sort(input, candidate);
+	});
+	print(name, tuning);
+	// Relative to the built-in tuning, so that every type counts the same in
+	// the combined profile
+	return [=](containers::sort_tuning const candidate) {
+		return seconds_to_sort(input, candidate) / baseline;
+	};
+}
+
+} // namespace
+
+int main(int argc, char * * argv) {
+	auto const size = argc > 1 ? static_cast<std::size_t>(std::stoull(argv[1])) : std::size_t(1) << 20U;
+	std::cout << "# sort_tuning profile for " << size << " elements\n";
+	auto const costs = std::tuple(
+		calibrate_type<std::uint16_t>("uint16", size),
+		calibrate_type<std::uint32_t>("uint32", size),
+		calibrate_type<std::uint64_t>("uint64", size),
+		calibrate_type<std::tuple<std::uint64_t, std::uint64_t>>("uint64_pair", size)
+	);
+	auto const combined = calibrate([&](containers::sort_tuning const candidate) {
+		return std::apply([&](auto const & ... cost) { return (... + cost(candidate)); }, costs);
+	});
+	print("default", combined);
+	std::cout <<
+		"# containers::set_default_sort_tuning(containers::sort_tuning(" <<
+		combined.std_sort_threshold << ", " <<
+		combined.american_flag_sort_threshold << "));\n";
+}
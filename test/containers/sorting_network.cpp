@@ -0,0 +1,82 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <std_module/prelude.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+import containers.algorithms.sort.sorting_network;
+
+import containers.algorithms.generate;
+import containers.begin_end;
+import containers.integer_range;
+import containers.legacy_iterator;
+import containers.vector;
+
+import bounded;
+import std_module;
+
+namespace {
+
+using namespace bounded::literal;
+
+template<typename T>
+auto matches_std_sort(std::mt19937 & engine) -> bool {
+	auto value_distribution = std::uniform_int_distribution<int>(-1000, 1000);
+	for (auto const size : containers::integer_range(containers::max_network_sort_size + 1_bi)) {
+		auto to_sort = containers::vector<T>(containers::generate_n(size, [&] {
+			return static_cast<T>(value_distribution(engine));
+		}));
+		auto expected = to_sort;
+		std::sort(
+			containers::make_legacy_iterator(containers::begin(expected)),
+			containers::make_legacy_iterator(containers::end(expected))
+		);
+		containers::network_sort(to_sort);
+		if (to_sort != expected) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("network_sort", "[network_sort]") {
+	auto engine = std::mt19937(1234);
+	for ([[maybe_unused]] auto const n : containers::integer_range(100_bi)) {
+		CHECK(matches_std_sort<std::int32_t>(engine));
+		CHECK(matches_std_sort<std::uint32_t>(engine));
+		CHECK(matches_std_sort<float>(engine));
+		CHECK(matches_std_sort<double>(engine));
+		CHECK(matches_std_sort<std::int64_t>(engine));
+		CHECK(matches_std_sort<std::int16_t>(engine));
+	}
+}
+
+TEST_CASE("network_sort infinity", "[network_sort]") {
+	auto to_sort = containers::vector<float>({
+		std::numeric_limits<float>::infinity(),
+		1.0F,
+		-std::numeric_limits<float>::infinity(),
+		std::numeric_limits<float>::infinity(),
+		0.0F,
+		-2.0F,
+		3.0F,
+		std::numeric_limits<float>::max(),
+		4.0F,
+	});
+	containers::network_sort(to_sort);
+	CHECK(to_sort == containers::vector<float>({
+		-std::numeric_limits<float>::infinity(),
+		-2.0F,
+		0.0F,
+		1.0F,
+		3.0F,
+		4.0F,
+		std::numeric_limits<float>::max(),
+		std::numeric_limits<float>::infinity(),
+		std::numeric_limits<float>::infinity(),
+	}));
+}
+
+} // namespace
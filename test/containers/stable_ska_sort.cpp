@@ -0,0 +1,155 @@
+// Copyright David Stone 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+module;
+
+#include <bounded/assert.hpp>
+
+export module containers.test.stable_ska_sort;
+
+import containers.algorithms.sort.sort_test_data;
+import containers.algorithms.sort.stable_ska_sort;
+import containers.algorithms.sort.to_radix_sort_key;
+
+import containers.array;
+
+import std_module;
+
+using namespace containers_test;
+
+constexpr auto test_stable_sort(auto data, auto function) {
+	containers::stable_ska_sort(data.input, std::move(function));
+	return data.input == data.expected;
+}
+
+constexpr auto test_stable_sort(auto data) {
+	return test_stable_sort(std::move(data), containers::to_radix_sort_key);
+}
+
+constexpr auto test_stable_sort_all(auto range) {
+	for (auto & data : range) {
+		BOUNDED_ASSERT(test_stable_sort(std::move(data)));
+	}
+	return true;
+}
+
+constexpr auto test_stable_sort_default_and_copy(auto data) {
+	BOUNDED_ASSERT(test_stable_sort(data, containers::to_radix_sort_key));
+	BOUNDED_ASSERT(test_stable_sort(std::move(data), default_copy));
+	return true;
+}
+
+constexpr auto test_stable_sort_default_and_copy_all(auto range) {
+	for (auto & data : range) {
+		BOUNDED_ASSERT(test_stable_sort(data, containers::to_radix_sort_key));
+		BOUNDED_ASSERT(test_stable_sort(std::move(data), default_copy));
+	}
+	return true;
+}
+
+static_assert(test_stable_sort(bool_0));
+static_assert(test_stable_sort_all(bool_1));
+static_assert(test_stable_sort_all(bool_2));
+static_assert(test_stable_sort_all(bool_3));
+static_assert(test_stable_sort(bool_many));
+
+static_assert(test_stable_sort_all(uint8_0));
+static_assert(test_stable_sort_all(uint8_1));
+static_assert(test_stable_sort_all(uint8_2));
+static_assert(test_stable_sort_all(uint8_3));
+static_assert(test_stable_sort(uint8_many));
+static_assert(test_stable_sort(uint8_256));
+
+static_assert(test_stable_sort(uint16_many));
+static_assert(test_stable_sort(uint32_many));
+static_assert(test_stable_sort(uint64_many));
+
+static_assert(test_stable_sort(tuple_many));
+
+static_assert(test_stable_sort_default_and_copy(array_uint8_1_1));
+static_assert(test_stable_sort_default_and_copy_all(array_uint8_1_2));
+static_assert(test_stable_sort_default_and_copy(array_uint8_1_3_one_value));
+static_assert(test_stable_sort_default_and_copy_all(array_uint8_1_3_two_values));
+static_assert(test_stable_sort_default_and_copy_all(array_uint8_1_3_three_values));
+static_assert(test_stable_sort_default_and_copy(array_uint8_4_many));
+static_assert(test_stable_sort_default_and_copy(array_uint16_many));
+
+static_assert(test_stable_sort(tuple_tuple));
+
+static_assert(test_stable_sort(make_move_only(), default_copy));
+static_assert(test_stable_sort(make_wrapper(), get_value_member));
+
+// Sorting by only the first element must keep the second in its original order
+static_assert([] {
+	using element = std::pair<std::uint16_t, int>;
+	auto to_sort = containers::array{
+		element(300, 0),
+		element(2, 1),
+		element(300, 2),
+		element(1, 3),
+		element(2, 4),
+		element(300, 5),
+		element(1, 6),
+	};
+	containers::stable_ska_sort(to_sort, [](element const & value) { return value.first; });
+	return to_sort == containers::array{
+		element(1, 3),
+		element(1, 6),
+		element(2, 1),
+		element(2, 4),
+		element(300, 0),
+		element(300, 2),
+		element(300, 5),
+	};
+}());
+
+// Signed and floating-point keys from an extractor are sorted by their radix
+// key, so they keep equal elements in order too
+struct event {
+	std::int64_t timestamp;
+	int id;
+	friend constexpr auto operator==(event, event) -> bool = default;
+};
+
+static_assert([] {
+	auto to_sort = containers::array{
+		event(5, 0),
+		event(-3, 1),
+		event(5, 2),
+		event(-1'000'000'000'000, 3),
+		event(-3, 4),
+		event(0, 5),
+		event(-1'000'000'000'000, 6),
+	};
+	containers::stable_ska_sort(to_sort, [](event const & value) { return value.timestamp; });
+	return to_sort == containers::array{
+		event(-1'000'000'000'000, 3),
+		event(-1'000'000'000'000, 6),
+		event(-3, 1),
+		event(-3, 4),
+		event(0, 5),
+		event(5, 0),
+		event(5, 2),
+	};
+}());
+
+static_assert([] {
+	using element = std::pair<double, int>;
+	auto to_sort = containers::array{
+		element(1.5, 0),
+		element(-2.0, 1),
+		element(1.5, 2),
+		element(-0.5, 3),
+		element(-2.0, 4),
+	};
+	containers::stable_ska_sort(to_sort, [](element const & value) { return value.first; });
+	return to_sort == containers::array{
+		element(-2.0, 1),
+		element(-2.0, 4),
+		element(-0.5, 3),
+		element(1.5, 0),
+		element(1.5, 2),
+	};
+}());